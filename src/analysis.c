@@ -0,0 +1,251 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "include/analysis.h"
+#include "include/maze_ctx.h"
+#include "include/arena.h"
+#include "include/util.h"
+
+/* Value of a cell in the distance array that has not been reached */
+#define DIST_UNREACHED SIZE_MAX
+
+/*
+ * Return the walls of the active cell at the specified position that are open
+ * towards an adjacent cell. Openings in the outer walls (i.e. the entrance and
+ * exit) are not included.
+ */
+static inline uint8_t passages(const MazeCtx* maze, int x, int y, int z) {
+    uint8_t result = ~maze->grid[maze_ctx_idx(maze, x, y, z)].walls;
+
+    /* The entrance and exit might be next to inactive cells, not the border */
+    if (x == maze->start.x && y == maze->start.y && z == maze->start.z)
+        result &= ~WALL_NORTH;
+    if (x == maze->end.x && y == maze->end.y && z == maze->end.z)
+        result &= ~WALL_SOUTH;
+
+    if (y <= 0)
+        result &= ~WALL_NORTH;
+    if (y >= maze->grid_h - 1)
+        result &= ~WALL_SOUTH;
+    if (x <= 0)
+        result &= ~WALL_WEST;
+    if (x >= maze->grid_w - 1)
+        result &= ~WALL_EAST;
+    if (z <= 0)
+        result &= ~WALL_UP;
+    if (z >= maze->grid_d - 1)
+        result &= ~WALL_DOWN;
+
+    return result & (WALL_NORTH | WALL_SOUTH | WALL_WEST | WALL_EAST |
+                     WALL_UP | WALL_DOWN);
+}
+
+/*
+ * Return the number of bits set in the argument.
+ */
+static inline int popcount(uint8_t n) {
+    int result = 0;
+    for (; n != 0; n &= n - 1)
+        result++;
+    return result;
+}
+
+/*
+ * Fill the metrics that only depend on each cell and its passages. Since the
+ * cells are independent of each other, the rows are split between threads.
+ * Only the spans of active cells are checked.
+ */
+static void local_sweep(MazeStats* stats, const MazeCtx* maze) {
+    const long num_rows = (long)maze->grid_h * maze->grid_d;
+
+    size_t junctions[MAX_PASSAGES + 1] = { 0 };
+    size_t corridors                   = 0;
+    size_t straight_corridors          = 0;
+    size_t num_cells                   = 0;
+
+#pragma omp parallel for reduction(+ : corridors, straight_corridors)         \
+  reduction(+ : num_cells) reduction(+ : junctions[:MAX_PASSAGES + 1])
+    for (long row = 0; row < num_rows; row++) {
+        const int y = row % maze->grid_h;
+        const int z = row / maze->grid_h;
+
+        for (size_t i = maze->row_spans[y]; i < maze->row_spans[y + 1]; i++) {
+            num_cells += maze->spans[i].x1 - maze->spans[i].x0;
+
+            for (int x = maze->spans[i].x0; x < maze->spans[i].x1; x++) {
+                const uint8_t open = passages(maze, x, y, z);
+                const int num_open = popcount(open);
+                junctions[num_open]++;
+
+                if (num_open != 2)
+                    continue;
+
+                corridors++;
+                if (open == (WALL_NORTH | WALL_SOUTH) ||
+                    open == (WALL_WEST | WALL_EAST) ||
+                    open == (WALL_UP | WALL_DOWN))
+                    straight_corridors++;
+            }
+        }
+    }
+
+    memcpy(stats->junctions, junctions, sizeof(junctions));
+    stats->num_cells          = num_cells;
+    stats->dead_ends          = junctions[1];
+    stats->corridors          = corridors;
+    stats->straight_corridors = straight_corridors;
+}
+
+/*
+ * Breadth-first search from the SRC cell index, storing the distance of each
+ * cell in DIST. The QUEUE array needs to be able to hold all cells. Returns the
+ * index of the farthest cell from SRC.
+ */
+static size_t bfs(const MazeCtx* maze,
+                  size_t src,
+                  size_t* dist,
+                  size_t* queue) {
+    const size_t layer_sz  = (size_t)maze->grid_w * maze->grid_h;
+    const size_t num_cells = layer_sz * maze->grid_d;
+
+    for (size_t i = 0; i < num_cells; i++)
+        dist[i] = DIST_UNREACHED;
+
+    size_t head = 0, tail = 0;
+    queue[tail++] = src;
+    dist[src]     = 0;
+
+    size_t cur = src;
+    while (head < tail) {
+        cur = queue[head++];
+
+        const int x = cur % maze->grid_w;
+        const int y = (cur % layer_sz) / maze->grid_w;
+        const int z = cur / layer_sz;
+
+        const uint8_t open = passages(maze, x, y, z);
+        const size_t neighbours[] = {
+            (open & WALL_NORTH) ? cur - maze->grid_w : DIST_UNREACHED,
+            (open & WALL_SOUTH) ? cur + maze->grid_w : DIST_UNREACHED,
+            (open & WALL_WEST) ? cur - 1 : DIST_UNREACHED,
+            (open & WALL_EAST) ? cur + 1 : DIST_UNREACHED,
+            (open & WALL_UP) ? cur - layer_sz : DIST_UNREACHED,
+            (open & WALL_DOWN) ? cur + layer_sz : DIST_UNREACHED,
+        };
+
+        for (size_t i = 0; i < sizeof(neighbours) / sizeof(*neighbours); i++) {
+            const size_t next = neighbours[i];
+            if (next == DIST_UNREACHED || dist[next] != DIST_UNREACHED)
+                continue;
+
+            dist[next]    = dist[cur] + 1;
+            queue[tail++] = next;
+        }
+    }
+
+    /* The last dequeued cell is always one of the farthest */
+    return cur;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t maze_stats_arena_size(int grid_w, int grid_h, int grid_d) {
+    const size_t num_cells = (size_t)grid_w * grid_h * grid_d;
+    return 2 * arena_aligned(num_cells * sizeof(size_t));
+}
+
+bool maze_stats_compute(MazeStats* stats,
+                        const MazeCtx* maze,
+                        Arena* arena) {
+    local_sweep(stats, maze);
+
+    /* The BFS buffers are only needed inside this function */
+    const size_t arena_pos = arena->pos;
+
+    const size_t num_cells =
+      (size_t)maze->grid_w * maze->grid_h * maze->grid_d;
+
+    size_t* dist  = arena_alloc(arena, num_cells * sizeof(size_t));
+    size_t* queue = arena_alloc(arena, num_cells * sizeof(size_t));
+    if (dist == NULL || queue == NULL) {
+        ERR("Failed to allocate BFS buffers.");
+        arena->pos = arena_pos;
+        return false;
+    }
+
+    /*
+     * The maze is a tree, so its longest path can be found with two BFS
+     * passes: the farthest cell from any cell is one end of the longest path,
+     * and the farthest cell from that one is the other end. The first pass
+     * starts at the entrance, so we also get the length of the solution.
+     */
+    const size_t start =
+      maze_ctx_idx(maze, maze->start.x, maze->start.y, maze->start.z);
+    const size_t end =
+      maze_ctx_idx(maze, maze->end.x, maze->end.y, maze->end.z);
+
+    const size_t farthest = bfs(maze, start, dist, queue);
+    stats->solution_len   = (dist[end] == DIST_UNREACHED) ? 0 : dist[end] + 1;
+
+    const size_t other_end = bfs(maze, farthest, dist, queue);
+    stats->longest_path    = dist[other_end] + 1;
+
+    arena->pos = arena_pos;
+    return true;
+}
+
+bool maze_stats_write_json(const MazeStats* stats, const char* filename) {
+    FILE* fd = fopen(filename, "w");
+    if (!fd) {
+        ERR("Can't open file '%s': %s", filename, strerror(errno));
+        return false;
+    }
+
+    fprintf(fd, "{\n");
+    fprintf(fd, "  \"cells\": %zu,\n", stats->num_cells);
+    fprintf(fd, "  \"dead_ends\": %zu,\n", stats->dead_ends);
+
+    fprintf(fd, "  \"junctions\": [");
+    for (int i = 0; i <= MAX_PASSAGES; i++)
+        fprintf(fd, (i == 0) ? "%zu" : ", %zu", stats->junctions[i]);
+    fprintf(fd, "],\n");
+
+    fprintf(fd, "  \"corridors\": %zu,\n", stats->corridors);
+    fprintf(fd, "  \"straight_corridors\": %zu,\n", stats->straight_corridors);
+    fprintf(fd,
+            "  \"river\": %f,\n",
+            (stats->corridors == 0)
+              ? 0.0
+              : (double)stats->straight_corridors / stats->corridors);
+    fprintf(fd, "  \"solution_length\": %zu,\n", stats->solution_len);
+    fprintf(fd,
+            "  \"solution_ratio\": %f,\n",
+            (double)stats->solution_len / stats->num_cells);
+    fprintf(fd, "  \"longest_path\": %zu\n", stats->longest_path);
+    fprintf(fd, "}\n");
+
+    fclose(fd);
+    return true;
+}
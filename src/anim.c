@@ -0,0 +1,456 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <png.h>
+#include <zlib.h>
+
+#include "include/anim.h"
+#include "include/image.h"
+#include "include/maze_ctx.h"
+#include "include/arena.h"
+#include "include/util.h"
+#include "include/config.h"
+
+/* Size of the compressed data written in each 'IDAT' or 'fdAT' chunk */
+#define ZBUF_SZ 0x10000
+
+/* Size of the sequence number at the start of each 'fdAT' chunk */
+#define SEQ_SZ 4
+
+static void put_u32(uint8_t* dst, uint32_t n) {
+    dst[0] = (n >> 24) & 0xFF;
+    dst[1] = (n >> 16) & 0xFF;
+    dst[2] = (n >> 8) & 0xFF;
+    dst[3] = n & 0xFF;
+}
+
+static void put_u16(uint8_t* dst, uint16_t n) {
+    dst[0] = (n >> 8) & 0xFF;
+    dst[1] = n & 0xFF;
+}
+
+/*
+ * Write a PNG chunk with the specified type and data, calculating its CRC.
+ */
+static bool write_chunk(FILE* fd,
+                        const char* type,
+                        const uint8_t* data,
+                        uint32_t len) {
+    uint8_t header[8];
+    put_u32(&header[0], len);
+    memcpy(&header[4], type, 4);
+
+    /* The CRC covers the chunk type and data, but not the length */
+    uLong crc = crc32(0L, &header[4], 4);
+    if (len > 0)
+        crc = crc32(crc, data, len);
+
+    uint8_t footer[4];
+    put_u32(footer, crc);
+
+    return fwrite(header, 1, sizeof(header), fd) == sizeof(header) &&
+           (len == 0 || fwrite(data, 1, len, fd) == len) &&
+           fwrite(footer, 1, sizeof(footer), fd) == sizeof(footer);
+}
+
+/*
+ * Write the 'acTL' chunk, with the current number of frames.
+ */
+static bool write_actl(Animation* anim) {
+    uint8_t data[8];
+    put_u32(&data[0], anim->num_frames);
+    put_u32(&data[4], 0); /* Loop forever */
+    return write_chunk(anim->fd, "acTL", data, sizeof(data));
+}
+
+/*
+ * Write the PNG signature and the chunks that precede the frames. The number
+ * of frames is not known yet, so the offset of the 'acTL' chunk is stored for
+ * overwriting it when finishing the animation.
+ */
+static bool write_apng_header(Animation* anim) {
+    static const uint8_t signature[] = { 0x89, 'P',  'N',  'G',
+                                         '\r', '\n', 0x1A, '\n' };
+    if (fwrite(signature, 1, sizeof(signature), anim->fd) != sizeof(signature))
+        return false;
+
+    uint8_t ihdr[13];
+    put_u32(&ihdr[0], anim->canvas.img_w);
+    put_u32(&ihdr[4], anim->canvas.img_h);
+    ihdr[8]  = 8;                    /* Bit depth */
+    ihdr[9]  = PNG_COLOR_TYPE_RGBA;  /* Color type */
+    ihdr[10] = 0;                    /* Compression method */
+    ihdr[11] = 0;                    /* Filter method */
+    ihdr[12] = PNG_INTERLACE_NONE;   /* Interlace method */
+    if (!write_chunk(anim->fd, "IHDR", ihdr, sizeof(ihdr)))
+        return false;
+
+    anim->actl_offset = ftell(anim->fd);
+    return anim->actl_offset >= 0 && write_actl(anim);
+}
+
+/*
+ * Write the compressed data that was stored in 'zbuf', and reset the output
+ * buffer of the stream. The data of the first frame is written as 'IDAT', so
+ * viewers without APNG support can display it.
+ */
+static bool flush_zbuf(Animation* anim, z_stream* strm) {
+    const uint32_t len = ZBUF_SZ - strm->avail_out;
+
+    bool result = true;
+    if (len > 0 && anim->num_frames == 0) {
+        result = write_chunk(anim->fd, "IDAT", &anim->zbuf[SEQ_SZ], len);
+    } else if (len > 0) {
+        put_u32(anim->zbuf, anim->sequence++);
+        result = write_chunk(anim->fd, "fdAT", anim->zbuf, len + SEQ_SZ);
+    }
+
+    strm->next_out  = &anim->zbuf[SEQ_SZ];
+    strm->avail_out = ZBUF_SZ;
+    return result;
+}
+
+/*
+ * Compress LEN bytes of DATA, writing the output chunks as 'zbuf' fills up.
+ */
+static bool compress_data(Animation* anim,
+                          z_stream* strm,
+                          const uint8_t* data,
+                          uInt len,
+                          int flush) {
+    strm->next_in  = (Bytef*)data;
+    strm->avail_in = len;
+
+    for (;;) {
+        if (strm->avail_out == 0 && !flush_zbuf(anim, strm))
+            return false;
+
+        const int ret = deflate(strm, flush);
+        if (ret == Z_STREAM_ERROR)
+            return false;
+
+        if (flush == Z_FINISH ? ret == Z_STREAM_END : strm->avail_in == 0)
+            return true;
+    }
+}
+
+/*
+ * Write the 'fcTL' chunk and the compressed rows of a frame. The frame is the
+ * VIEW image, positioned at (X, Y) of the canvas, and it's displayed for
+ * DELAY_MS milliseconds.
+ */
+static bool write_apng_frame(Animation* anim,
+                             const Image* view,
+                             int x,
+                             int y,
+                             uint16_t delay_ms) {
+    uint8_t fctl[26];
+    put_u32(&fctl[0], anim->sequence++);
+    put_u32(&fctl[4], view->img_w);
+    put_u32(&fctl[8], view->img_h);
+    put_u32(&fctl[12], x);
+    put_u32(&fctl[16], y);
+    put_u16(&fctl[20], delay_ms); /* Delay numerator */
+    put_u16(&fctl[22], 1000);     /* Delay denominator */
+    fctl[24] = 0; /* APNG_DISPOSE_OP_NONE */
+    fctl[25] = 0; /* APNG_BLEND_OP_SOURCE */
+    if (!write_chunk(anim->fd, "fcTL", fctl, sizeof(fctl)))
+        return false;
+
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree  = Z_NULL;
+    strm.opaque = Z_NULL;
+    if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK)
+        return false;
+
+    strm.next_out  = &anim->zbuf[SEQ_SZ];
+    strm.avail_out = ZBUF_SZ;
+
+    /* Each row is preceded by its filter type, in our case none (0) */
+    static const uint8_t filter_type = 0;
+
+    bool result = true;
+    for (int i = 0; i < view->img_h && result; i++)
+        result = compress_data(anim, &strm, &filter_type, 1, Z_NO_FLUSH) &&
+                 compress_data(anim,
+                               &strm,
+                               view->rows[i],
+                               view->img_w * COL_SZ,
+                               Z_NO_FLUSH);
+
+    result = result && compress_data(anim, &strm, NULL, 0, Z_FINISH) &&
+             flush_zbuf(anim, &strm);
+
+    deflateEnd(&strm);
+    return result;
+}
+
+/*
+ * Write all the rows of the canvas, without any header.
+ */
+static bool write_raw_frame(Animation* anim) {
+    const size_t row_sz = (size_t)anim->canvas.img_w * COL_SZ;
+
+    for (int y = 0; y < anim->canvas.img_h; y++)
+        if (fwrite(anim->canvas.rows[y], 1, row_sz, anim->fd) != row_sz)
+            return false;
+
+    return true;
+}
+
+/*
+ * Close the output file of the animation, unless it's 'stdout'.
+ */
+static void close_output(Animation* anim) {
+    if (anim->raw)
+        fflush(anim->fd);
+    else
+        fclose(anim->fd);
+}
+
+/*
+ * Mark the pixels of the specified cell as changed since the last frame,
+ * including the part of its walls that overlaps the adjacent cells of the same
+ * layer.
+ */
+static void mark_dirty(Animation* anim, const MazeCtx* maze, Vec3 cell) {
+    const int half_w  = WALL_WIDTH / 2;
+    const int layer_h = maze->grid_h * CELL_SZ;
+    const int row     = cell.z * maze->grid_h + cell.y;
+    const int px_y    = row * CELL_SZ - half_w;
+    const int x0      = cell.x * CELL_SZ - half_w;
+    const int x1      = x0 + CELL_SZ + WALL_WIDTH;
+
+    /* The rectangle is clipped to the layer */
+    const int y0 = MAX(px_y, cell.z * layer_h);
+    const int y1 = MIN(px_y + CELL_SZ + WALL_WIDTH, (cell.z + 1) * layer_h);
+
+    DirtyRect* rect = &anim->dirty[cell.z];
+    if (!rect->dirty) {
+        rect->dirty = true;
+        rect->x0    = x0;
+        rect->y0    = y0;
+        rect->x1    = x1;
+        rect->y1    = y1;
+        return;
+    }
+
+    rect->x0 = MIN(rect->x0, x0);
+    rect->y0 = MIN(rect->y0, y0);
+    rect->x1 = MAX(rect->x1, x1);
+    rect->y1 = MAX(rect->y1, y1);
+}
+
+/*
+ * Draw the specified rectangle of the canvas. For APNG files, the rectangle is
+ * also written as a new frame, displayed for DELAY_MS milliseconds.
+ */
+static bool draw_frame_rect(Animation* anim,
+                            const MazeCtx* maze,
+                            const DirtyRect* rect,
+                            uint16_t delay_ms) {
+    const int x0 = MAX(rect->x0, 0);
+    const int y0 = MAX(rect->y0, 0);
+    const int x1 = MIN(rect->x1, anim->canvas.img_w);
+    const int y1 = MIN(rect->y1, anim->canvas.img_h);
+
+    Image view;
+    image_view(&view, anim->view_rows, &anim->canvas, x0, y0, x1 - x0, y1 - y0);
+    maze_region_to_image(&view, maze, x0, y0);
+
+    if (anim->raw)
+        return true;
+
+    const bool result = write_apng_frame(anim, &view, x0, y0, delay_ms);
+    anim->num_frames++;
+    return result;
+}
+
+/*
+ * Draw the changed rectangles of the canvas, and write them. The first frame
+ * always contains the whole canvas. In APNG files, each changed layer is a
+ * separate frame, and only the last one has a delay, so they are displayed
+ * together. Raw frames always contain the whole canvas.
+ */
+static void write_frame(Animation* anim, const MazeCtx* maze) {
+    if (anim->failed)
+        return;
+
+    bool written = true;
+    bool changed = false;
+
+    if (anim->num_frames == 0) {
+        const DirtyRect whole = {
+            true, 0, 0, anim->canvas.img_w, anim->canvas.img_h,
+        };
+        written = draw_frame_rect(anim, maze, &whole, ANIM_DELAY_MS);
+        changed = true;
+
+        for (int z = 0; z < anim->num_layers; z++)
+            anim->dirty[z].dirty = false;
+    }
+
+    /* The last changed layer is the one with the delay */
+    int last = -1;
+    for (int z = 0; z < anim->num_layers; z++)
+        if (anim->dirty[z].dirty)
+            last = z;
+
+    for (int z = 0; z <= last && written; z++) {
+        if (!anim->dirty[z].dirty)
+            continue;
+
+        written = draw_frame_rect(anim,
+                                  maze,
+                                  &anim->dirty[z],
+                                  (z == last) ? ANIM_DELAY_MS : 0);
+        anim->dirty[z].dirty = false;
+        changed              = true;
+    }
+
+    if (anim->raw && changed) {
+        written = written && write_raw_frame(anim);
+        anim->num_frames++;
+    }
+
+    if (!written) {
+        ERR("Failed to write animation frame: %s", strerror(errno));
+        anim->failed = true;
+    }
+}
+
+/*
+ * Function called by the maze context after removing the walls between two
+ * cells.
+ */
+static void on_carve(const MazeCtx* maze, Vec3 a, Vec3 b, void* data) {
+    Animation* anim = data;
+
+    mark_dirty(anim, maze, a);
+    mark_dirty(anim, maze, b);
+
+    anim->num_carves++;
+    if (anim->num_frames == 0 || anim->num_carves % anim->step == 0)
+        write_frame(anim, maze);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t anim_arena_size(int grid_w, int grid_h, int grid_d) {
+    const int canvas_h = grid_h * grid_d * CELL_SZ;
+    return image_arena_size(grid_w * CELL_SZ, canvas_h) +
+           arena_aligned(canvas_h * sizeof(png_bytep)) +
+           arena_aligned(grid_d * sizeof(DirtyRect)) +
+           arena_aligned(SEQ_SZ + ZBUF_SZ);
+}
+
+bool anim_init(Animation* anim,
+               MazeCtx* maze,
+               Arena* arena,
+               const char* filename,
+               int step) {
+    anim->raw = (strcmp(filename, "-") == 0);
+    anim->fd  = anim->raw ? stdout : fopen(filename, "wb");
+    if (anim->fd == NULL) {
+        ERR("Can't open file '%s': %s", filename, strerror(errno));
+        return false;
+    }
+
+    anim->failed     = false;
+    anim->step       = step;
+    anim->num_carves = 0;
+    anim->num_frames = 0;
+    anim->sequence   = 0;
+    anim->num_layers = maze->grid_d;
+    anim->arena      = arena;
+    anim->arena_pos  = arena->pos;
+
+    if (!image_init(&anim->canvas,
+                    arena,
+                    maze->grid_w * CELL_SZ,
+                    maze->grid_h * maze->grid_d * CELL_SZ)) {
+        ERR("Failed to allocate animation canvas.");
+        close_output(anim);
+        arena->pos = anim->arena_pos;
+        return false;
+    }
+
+    anim->view_rows =
+      arena_alloc(arena, anim->canvas.img_h * sizeof(png_bytep));
+    anim->dirty = arena_alloc(arena, anim->num_layers * sizeof(DirtyRect));
+    anim->zbuf  = arena_alloc(arena, SEQ_SZ + ZBUF_SZ);
+    if (anim->view_rows == NULL || anim->dirty == NULL || anim->zbuf == NULL) {
+        ERR("Failed to allocate animation buffers.");
+        close_output(anim);
+        arena->pos = anim->arena_pos;
+        return false;
+    }
+
+    for (int z = 0; z < anim->num_layers; z++)
+        anim->dirty[z].dirty = false;
+
+    if (anim->raw) {
+        fprintf(stderr,
+                "Streaming %dx%d RGBA frames...\n",
+                anim->canvas.img_w,
+                anim->canvas.img_h);
+    } else if (!write_apng_header(anim)) {
+        ERR("Failed to write APNG header: %s", strerror(errno));
+        close_output(anim);
+        arena->pos = anim->arena_pos;
+        return false;
+    }
+
+    maze->on_carve   = on_carve;
+    maze->carve_data = anim;
+    return true;
+}
+
+bool anim_finish(Animation* anim, MazeCtx* maze) {
+    maze->on_carve   = NULL;
+    maze->carve_data = NULL;
+
+    /* The walls of the entrance and exit are removed after the last carve */
+    mark_dirty(anim, maze, maze->start);
+    mark_dirty(anim, maze, maze->end);
+    write_frame(anim, maze);
+
+    if (!anim->raw && !anim->failed) {
+        /* Overwrite the 'acTL' chunk, now that we know the number of frames */
+        if (!write_chunk(anim->fd, "IEND", NULL, 0) ||
+            fseek(anim->fd, anim->actl_offset, SEEK_SET) != 0 ||
+            !write_actl(anim)) {
+            ERR("Failed to finish APNG file: %s", strerror(errno));
+            anim->failed = true;
+        }
+    }
+
+    close_output(anim);
+
+    /* Release the canvas and the buffers */
+    anim->arena->pos = anim->arena_pos;
+
+    return !anim->failed;
+}
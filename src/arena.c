@@ -0,0 +1,94 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Needed for 'MAP_ANONYMOUS', 'MAP_HUGETLB' and 'madvise' */
+#define _DEFAULT_SOURCE 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/mman.h>
+
+#include "include/arena.h"
+#include "include/config.h"
+
+/* Size of the huge pages used when mapping the arena */
+#define HUGE_PAGE_SZ (2 * 1024 * 1024)
+
+/*
+ * Map SIZE bytes of anonymous memory, with the specified extra flags. Returns
+ * NULL on failure.
+ */
+static void* map_anonymous(size_t size, int flags) {
+    void* result = mmap(NULL,
+                        size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | flags,
+                        -1,
+                        0);
+    return (result == MAP_FAILED) ? NULL : result;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool arena_init(Arena* arena, size_t size) {
+    arena->data = NULL;
+    arena->pos  = 0;
+
+#if ARENA_HUGE_PAGES
+    /*
+     * Try to use explicit huge pages first, which are usually not reserved by
+     * the system. Small arenas would waste most of the page.
+     */
+    if (size >= HUGE_PAGE_SZ) {
+        arena->size = (size + HUGE_PAGE_SZ - 1) & ~(size_t)(HUGE_PAGE_SZ - 1);
+        arena->data = map_anonymous(arena->size, MAP_HUGETLB);
+    }
+#endif
+
+    if (arena->data == NULL) {
+        arena->size = size;
+        arena->data = map_anonymous(arena->size, 0);
+        if (arena->data == NULL)
+            return false;
+
+#if ARENA_HUGE_PAGES
+        /* Fall back to transparent huge pages, if available */
+        madvise(arena->data, arena->size, MADV_HUGEPAGE);
+#endif
+    }
+
+    return true;
+}
+
+void arena_destroy(Arena* arena) {
+    if (arena->data != NULL) {
+        munmap(arena->data, arena->size);
+        arena->data = NULL;
+    }
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    const size_t aligned_size = arena_aligned(size);
+    if (aligned_size < size || aligned_size > arena->size - arena->pos)
+        return NULL;
+
+    void* result = &arena->data[arena->pos];
+    arena->pos += aligned_size;
+    return result;
+}
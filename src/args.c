@@ -0,0 +1,148 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "include/args.h"
+#include "include/image.h"
+#include "include/util.h"
+#include "include/config.h"
+
+bool parse_args(Args* args, int argc, char** argv) {
+    /* Default arguments */
+    args->output_filename = "output.png";
+    args->stats_filename  = NULL;
+    args->anim_filename   = NULL;
+    args->mask_filename   = NULL;
+    args->anim_step       = ANIM_STEP;
+    args->render          = true;
+    args->grid_w          = 100;
+    args->grid_h          = 100;
+    args->grid_d          = 1;
+    args->seed            = time(NULL);
+
+    int num_positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stats") == 0) {
+            if (++i >= argc) {
+                ERR("Missing filename for '--stats'.");
+                return false;
+            }
+            args->stats_filename = argv[i];
+        } else if (strcmp(argv[i], "--animate") == 0) {
+            if (++i >= argc) {
+                ERR("Missing filename for '--animate'.");
+                return false;
+            }
+            args->anim_filename = argv[i];
+        } else if (strcmp(argv[i], "--anim-step") == 0) {
+            if (++i >= argc) {
+                ERR("Missing number for '--anim-step'.");
+                return false;
+            }
+            args->anim_step = atoi(argv[i]);
+        } else if (strcmp(argv[i], "--mask") == 0) {
+            if (++i >= argc) {
+                ERR("Missing filename for '--mask'.");
+                return false;
+            }
+            args->mask_filename = argv[i];
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            if (++i >= argc) {
+                ERR("Missing number for '--seed'.");
+                return false;
+            }
+            args->seed = strtoul(argv[i], NULL, 10);
+        } else if (strcmp(argv[i], "--no-image") == 0) {
+            args->render = false;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            ERR("Unknown option: '%s'", argv[i]);
+            return false;
+        } else {
+            switch (num_positional++) {
+                case 0:
+                    args->output_filename = argv[i];
+                    break;
+                case 1:
+                    args->grid_w = atoi(argv[i]);
+                    break;
+                case 2:
+                    args->grid_h = atoi(argv[i]);
+                    break;
+                case 3:
+                    args->grid_d = atoi(argv[i]);
+                    break;
+                default:
+                    ERR("Too many arguments.");
+                    return false;
+            }
+        }
+    }
+
+    if (args->grid_w <= 0 || args->grid_h <= 0 || args->grid_d <= 0) {
+        ERR("Invalid grid size.");
+        return false;
+    }
+
+    /* The size of the images in pixels, and the size of their rows in bytes,
+     * must fit in an 'int' */
+    if (args->grid_w > INT_MAX / COL_SZ / CELL_SZ ||
+        args->grid_h > INT_MAX / CELL_SZ / args->grid_d) {
+        ERR("Grid size is too big.");
+        return false;
+    }
+
+    /* If the filename is a format, all the layer filenames must fit. The last
+     * layer has the longest number. */
+    args->per_layer = image_is_layer_format(args->output_filename);
+    if (args->per_layer) {
+        const int len =
+          snprintf(NULL, 0, args->output_filename, args->grid_d - 1);
+        if (len < 0 || len >= FILENAME_MAX) {
+            ERR("Output filename is too long.");
+            return false;
+        }
+    }
+
+    if (args->anim_step <= 0) {
+        ERR("Invalid animation step.");
+        return false;
+    }
+
+    return true;
+}
+
+void print_usage(const char* name) {
+    fprintf(stderr,
+            "Usage: %s [OPTION...] [OUTPUT.png] [WIDTH] [HEIGHT] [LAYERS]\n"
+            "Options:\n"
+            "  --stats FILE.json  Write maze metrics to FILE.json\n"
+            "  --animate FILE     Write the generation as an APNG to FILE, or "
+            "raw\n"
+            "                     RGBA frames to stdout if FILE is '-'\n"
+            "  --anim-step N      Write a frame every N carves\n"
+            "  --mask FILE.png    Only generate cells where FILE.png is light\n"
+            "  --seed N           Seed used for generating the maze\n"
+            "  --no-image         Don't write the PNG image\n",
+            name);
+}
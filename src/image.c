@@ -26,105 +26,128 @@
 
 #include "include/image.h"
 #include "include/maze_ctx.h"
+#include "include/arena.h"
 #include "include/util.h"
 #include "include/config.h"
 
-/* Bytes of each entry in the 'MazeCtx.rows' array */
-#define COL_SZ 4
-
 static void draw_rect(Image* img, int x, int y, int w, int h, uint64_t c) {
-    for (int cur_y = y; cur_y < y + h; cur_y++) {
-        /* To get the real position in the rows array, we need to multiply the
-         * positions by the size of each element: COL_SZ (4) */
-        for (int cur_x = x * COL_SZ; cur_x < (x + w) * COL_SZ;
-             cur_x += COL_SZ) {
-            /* Make sure we are not out of bounds */
-            if (cur_x < 0 || cur_x >= img->img_w * 4 || cur_y < 0 ||
-                cur_y >= img->img_h)
-                continue;
-
-            img->rows[cur_y][cur_x]     = (c >> 24) & 0xFF; /* r */
-            img->rows[cur_y][cur_x + 1] = (c >> 16) & 0xFF; /* g */
-            img->rows[cur_y][cur_x + 2] = (c >> 8) & 0xFF;  /* b */
-            img->rows[cur_y][cur_x + 3] = c & 0xFF;         /* a */
-        }
-    }
-}
+    /* Make sure we are not out of bounds */
+    const int x0 = MAX(x, 0);
+    const int y0 = MAX(y, 0);
+    const int x1 = MIN(x + w, img->img_w);
+    const int y1 = MIN(y + h, img->img_h);
 
-static void maze_ctx_to_image(Image* img, const MazeCtx* maze) {
-    /* Clear rows with background */
-    draw_rect(img, 0, 0, img->img_w, img->img_h, COL_BACKGROUND);
+    for (int cur_y = y0; cur_y < y1; cur_y++) {
+        for (int cur_x = x0; cur_x < x1; cur_x++) {
+            /* To get the real position in the rows array, we need to multiply
+             * the positions by the size of each element: COL_SZ (4) */
+            png_bytep pixel = &img->rows[cur_y][(size_t)cur_x * COL_SZ];
 
-    for (int y = 0; y < maze->grid_h; y++) {
-        for (int x = 0; x < maze->grid_w; x++) {
-            const int px_y   = y * CELL_SZ;
-            const int px_x   = x * CELL_SZ;
-            const int half_w = WALL_WIDTH / 2;
-
-            if (maze->grid[maze->grid_w * y + x].walls & WALL_NORTH)
-                draw_rect(img,
-                          px_x - half_w,
-                          px_y - half_w,
-                          CELL_SZ + WALL_WIDTH,
-                          WALL_WIDTH,
-                          COL_WALL);
-
-            if (maze->grid[maze->grid_w * y + x].walls & WALL_SOUTH)
-                draw_rect(img,
-                          px_x - half_w,
-                          px_y + CELL_SZ - half_w,
-                          CELL_SZ + WALL_WIDTH,
-                          WALL_WIDTH,
-                          COL_WALL);
-
-            if (maze->grid[maze->grid_w * y + x].walls & WALL_WEST)
-                draw_rect(img,
-                          px_x - half_w,
-                          px_y - half_w,
-                          WALL_WIDTH,
-                          CELL_SZ + WALL_WIDTH,
-                          COL_WALL);
-
-            if (maze->grid[maze->grid_w * y + x].walls & WALL_EAST)
-                draw_rect(img,
-                          px_x + CELL_SZ - half_w,
-                          px_y - half_w,
-                          WALL_WIDTH,
-                          CELL_SZ + WALL_WIDTH,
-                          COL_WALL);
+            pixel[0] = (c >> 24) & 0xFF; /* r */
+            pixel[1] = (c >> 16) & 0xFF; /* g */
+            pixel[2] = (c >> 8) & 0xFF;  /* b */
+            pixel[3] = c & 0xFF;         /* a */
         }
     }
 }
 
-static bool image_init(Image* img, const MazeCtx* maze) {
-    img->img_w = maze->grid_w * CELL_SZ;
-    img->img_h = maze->grid_h * CELL_SZ;
+/* Size of the squares marking passages between layers */
+#define MARKER_SZ (CELL_SZ / 3)
 
-    img->rows = malloc(img->img_h * sizeof(png_bytep));
-    if (img->rows == NULL)
-        return false;
+/*
+ * Draw the walls of a single cell of the maze. The cell is specified by its
+ * column and row in the vertically stacked layers, and it's drawn at its
+ * position in those stacked layers, minus (OFF_X, OFF_Y).
+ */
+static void draw_cell(Image* img,
+                      const MazeCtx* maze,
+                      int x,
+                      int row,
+                      int off_x,
+                      int off_y) {
+    const int y      = row % maze->grid_h;
+    const int z      = row / maze->grid_h;
+    const int px_y   = row * CELL_SZ - off_y;
+    const int px_x   = x * CELL_SZ - off_x;
+    const int half_w = WALL_WIDTH / 2;
+    const uint8_t walls = maze->grid[maze_ctx_idx(maze, x, y, z)].walls;
 
-    for (int y = 0; y < img->img_h; y++) {
-        img->rows[y] = malloc(img->img_w * COL_SZ);
-        if (img->rows[y] == NULL)
-            return false;
-    }
+    if (walls & WALL_NORTH)
+        draw_rect(img,
+                  px_x - half_w,
+                  px_y - half_w,
+                  CELL_SZ + WALL_WIDTH,
+                  WALL_WIDTH,
+                  COL_WALL);
 
-    return true;
-}
+    if (walls & WALL_SOUTH)
+        draw_rect(img,
+                  px_x - half_w,
+                  px_y + CELL_SZ - half_w,
+                  CELL_SZ + WALL_WIDTH,
+                  WALL_WIDTH,
+                  COL_WALL);
 
-static void image_destroy(Image* img) {
-    if (img->rows != NULL) {
-        for (int y = 0; y < img->img_h; y++)
-            free(img->rows[y]);
-        free(img->rows);
-        img->rows = NULL;
-    }
+    if (walls & WALL_WEST)
+        draw_rect(img,
+                  px_x - half_w,
+                  px_y - half_w,
+                  WALL_WIDTH,
+                  CELL_SZ + WALL_WIDTH,
+                  COL_WALL);
+
+    if (walls & WALL_EAST)
+        draw_rect(img,
+                  px_x + CELL_SZ - half_w,
+                  px_y - half_w,
+                  WALL_WIDTH,
+                  CELL_SZ + WALL_WIDTH,
+                  COL_WALL);
+
+    /* Passages between layers are marked in opposite corners */
+    if (!(walls & WALL_UP))
+        draw_rect(img,
+                  px_x + half_w + 1,
+                  px_y + half_w + 1,
+                  MARKER_SZ,
+                  MARKER_SZ,
+                  COL_UP);
+
+    if (!(walls & WALL_DOWN))
+        draw_rect(img,
+                  px_x + CELL_SZ - half_w - 1 - MARKER_SZ,
+                  px_y + CELL_SZ - half_w - 1 - MARKER_SZ,
+                  MARKER_SZ,
+                  MARKER_SZ,
+                  COL_DOWN);
 }
 
-/*----------------------------------------------------------------------------*/
+/*
+ * Draw the specified layer of the maze into the image. The image only needs to
+ * be big enough for a single layer. Only the spans of active cells are drawn.
+ */
+static void maze_layer_to_image(Image* img, const MazeCtx* maze, int z) {
+    /* Clear rows with background */
+    draw_rect(img, 0, 0, img->img_w, img->img_h, COL_BACKGROUND);
+
+    const int first_row = z * maze->grid_h;
+    for (int y = 0; y < maze->grid_h; y++)
+        for (size_t i = maze->row_spans[y]; i < maze->row_spans[y + 1]; i++)
+            for (int x = maze->spans[i].x0; x < maze->spans[i].x1; x++)
+                draw_cell(img, maze, x, first_row + y, 0, first_row * CELL_SZ);
+}
 
-bool write_png_from_maze_ctx(const MazeCtx* maze, const char* output_filename) {
+/*
+ * Write NUM_LAYERS layers of the maze, starting at FIRST_LAYER, into a single
+ * PNG file. The layers are stacked vertically, and each one is rendered into
+ * IMG and written before rendering the next, so only a single layer is stored
+ * in memory at any given time.
+ */
+static bool write_png_layers(const MazeCtx* maze,
+                             Image* img,
+                             const char* output_filename,
+                             int first_layer,
+                             int num_layers) {
     FILE* fd = fopen(output_filename, "wb");
     if (!fd) {
         ERR("Can't open file '%s': %s", output_filename, strerror(errno));
@@ -135,6 +158,7 @@ bool write_png_from_maze_ctx(const MazeCtx* maze, const char* output_filename) {
       png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (png == NULL) {
         ERR("Can't create 'png_structp'.");
+        fclose(fd);
         return false;
     }
 
@@ -142,18 +166,17 @@ bool write_png_from_maze_ctx(const MazeCtx* maze, const char* output_filename) {
     if (!info)
         DIE("Can't create 'png_infop'.");
 
-    Image img;
-    if (!image_init(&img, maze))
-        return false;
-
-    printf("Writing %dx%d file...\n", img.img_w, img.img_h);
+    fprintf(stderr,
+            "Writing %dx%d file...\n",
+            img->img_w,
+            img->img_h * num_layers);
 
     /* Specify the PNG info */
     png_init_io(png, fd);
     png_set_IHDR(png,
                  info,
-                 img.img_w,
-                 img.img_h,
+                 img->img_w,
+                 img->img_h * num_layers,
                  8,
                  PNG_COLOR_TYPE_RGBA,
                  PNG_INTERLACE_NONE,
@@ -161,16 +184,165 @@ bool write_png_from_maze_ctx(const MazeCtx* maze, const char* output_filename) {
                  PNG_FILTER_TYPE_DEFAULT);
     png_write_info(png, info);
 
-    /* Convert the grid to png */
-    maze_ctx_to_image(&img, maze);
+    /* Convert each layer of the grid to png, and write its rows */
+    for (int z = first_layer; z < first_layer + num_layers; z++) {
+        maze_layer_to_image(img, maze, z);
+        png_write_rows(png, img->rows, img->img_h);
+    }
 
-    /* Write the rows */
-    png_write_image(png, img.rows);
     png_write_end(png, NULL);
-
-    image_destroy(&img);
     png_destroy_write_struct(&png, &info);
     fclose(fd);
 
     return true;
 }
+
+/*----------------------------------------------------------------------------*/
+
+bool image_is_layer_format(const char* fmt) {
+    int num_ints = 0;
+
+    while (*fmt != '\0') {
+        if (*fmt++ != '%')
+            continue;
+
+        if (*fmt == '%') {
+            fmt++;
+            continue;
+        }
+
+        /* Skip the flags, width and precision of the conversion */
+        fmt += strspn(fmt, "-+ #0");
+        fmt += strspn(fmt, "0123456789");
+        if (*fmt == '.') {
+            fmt++;
+            fmt += strspn(fmt, "0123456789");
+        }
+
+        if (*fmt != 'd')
+            return false;
+
+        fmt++;
+        num_ints++;
+    }
+
+    return num_ints == 1;
+}
+
+size_t image_arena_size(int img_w, int img_h) {
+    return arena_aligned(img_h * sizeof(png_bytep)) +
+           arena_aligned((size_t)img_w * img_h * COL_SZ);
+}
+
+bool image_init(Image* img, Arena* arena, int img_w, int img_h) {
+    img->img_w = img_w;
+    img->img_h = img_h;
+
+    /* All the pixels are contiguous, and each row points inside them */
+    img->rows = arena_alloc(arena, img->img_h * sizeof(png_bytep));
+    png_bytep pixels =
+      arena_alloc(arena, (size_t)img->img_w * img->img_h * COL_SZ);
+    if (img->rows == NULL || pixels == NULL)
+        return false;
+
+    for (int y = 0; y < img->img_h; y++)
+        img->rows[y] = &pixels[(size_t)y * img->img_w * COL_SZ];
+
+    return true;
+}
+
+void image_view(Image* view,
+                png_bytep* rows,
+                const Image* img,
+                int x,
+                int y,
+                int w,
+                int h) {
+    view->rows  = rows;
+    view->img_w = w;
+    view->img_h = h;
+
+    for (int i = 0; i < h; i++)
+        view->rows[i] = img->rows[y + i] + (size_t)x * COL_SZ;
+}
+
+void maze_region_to_image(Image* img,
+                          const MazeCtx* maze,
+                          int px_x,
+                          int px_y) {
+    draw_rect(img, 0, 0, img->img_w, img->img_h, COL_BACKGROUND);
+
+    /* Walls overlap the adjacent cells, so draw an extra cell on each side */
+    const int num_rows = maze->grid_h * maze->grid_d;
+    const int x0   = MAX(px_x / CELL_SZ - 1, 0);
+    const int row0 = MAX(px_y / CELL_SZ - 1, 0);
+    const int x1 =
+      MIN((px_x + img->img_w - 1) / CELL_SZ + 1, maze->grid_w - 1);
+    const int row1 =
+      MIN((px_y + img->img_h - 1) / CELL_SZ + 1, num_rows - 1);
+
+    for (int row = row0; row <= row1; row++) {
+        const int y = row % maze->grid_h;
+
+        /* Only draw the part of each span that overlaps the image */
+        for (size_t i = maze->row_spans[y]; i < maze->row_spans[y + 1]; i++) {
+            const int span_x0 = MAX(maze->spans[i].x0, x0);
+            const int span_x1 = MIN(maze->spans[i].x1, x1 + 1);
+            for (int x = span_x0; x < span_x1; x++)
+                draw_cell(img, maze, x, row, px_x, px_y);
+        }
+    }
+}
+
+bool write_png_from_maze_ctx(const MazeCtx* maze,
+                             Arena* arena,
+                             const char* output_filename) {
+    /* The image is only needed inside this function */
+    const size_t arena_pos = arena->pos;
+
+    Image img;
+    if (!image_init(&img,
+                    arena,
+                    maze->grid_w * CELL_SZ,
+                    maze->grid_h * CELL_SZ))
+        return false;
+
+    const bool result =
+      write_png_layers(maze, &img, output_filename, 0, maze->grid_d);
+
+    arena->pos = arena_pos;
+    return result;
+}
+
+bool write_layer_pngs_from_maze_ctx(const MazeCtx* maze,
+                                    Arena* arena,
+                                    const char* filename_fmt) {
+    if (!image_is_layer_format(filename_fmt)) {
+        ERR("Invalid layer filename format: '%s'", filename_fmt);
+        return false;
+    }
+
+    const size_t arena_pos = arena->pos;
+
+    Image img;
+    if (!image_init(&img,
+                    arena,
+                    maze->grid_w * CELL_SZ,
+                    maze->grid_h * CELL_SZ))
+        return false;
+
+    bool result = true;
+    for (int z = 0; z < maze->grid_d && result; z++) {
+        char filename[FILENAME_MAX];
+        const int len = snprintf(filename, sizeof(filename), filename_fmt, z);
+        if (len < 0 || (size_t)len >= sizeof(filename)) {
+            ERR("Layer filename is too long: '%s'", filename_fmt);
+            result = false;
+        } else {
+            result = write_png_layers(maze, &img, filename, z, 1);
+        }
+    }
+
+    arena->pos = arena_pos;
+    return result;
+}
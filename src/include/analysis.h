@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANALYSIS_H_
+#define ANALYSIS_H_ 1
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "maze_ctx.h"
+#include "arena.h"
+
+/* Maximum number of passages of a cell, used for the junction histogram */
+#define MAX_PASSAGES 6
+
+/*
+ * Structure with the structural metrics of a generated maze.
+ */
+typedef struct {
+    size_t num_cells; /* Active cells only */
+
+    /* Number of cells with N passages, indexed by N */
+    size_t junctions[MAX_PASSAGES + 1];
+    size_t dead_ends;
+
+    /*
+     * Number of corridor cells (exactly two passages), and how many of those
+     * continue in a straight line. Their ratio is the "river" factor of the
+     * maze: mazes with long straight corridors are usually easier.
+     */
+    size_t corridors;
+    size_t straight_corridors;
+
+    /* Cells in the path from the entrance to the exit, including both */
+    size_t solution_len;
+
+    /* Cells in the longest path of the maze, including both ends */
+    size_t longest_path;
+} MazeStats;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Return the bytes needed in an arena by 'maze_stats_compute' for a maze with
+ * the specified size.
+ */
+size_t maze_stats_arena_size(int grid_w, int grid_h, int grid_d);
+
+/*
+ * Fill the 'MazeStats' structure with the metrics of the specified maze, which
+ * must have been generated already. Runs in linear time on the number of
+ * cells. The temporary buffers are allocated from the arena, and released
+ * before returning.
+ */
+bool maze_stats_compute(MazeStats* stats,
+                        const MazeCtx* maze,
+                        Arena* arena);
+
+/*
+ * Write the specified maze metrics as a JSON object into a file.
+ */
+bool maze_stats_write_json(const MazeStats* stats, const char* filename);
+
+#endif /* ANALYSIS_H_ */
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ANIM_H_
+#define ANIM_H_ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <png.h>
+
+#include "maze_ctx.h"
+#include "image.h"
+#include "arena.h"
+
+/*
+ * Rectangle of a layer that changed since the last frame, in pixels of the
+ * canvas.
+ */
+typedef struct {
+    bool dirty;
+    int x0, y0, x1, y1;
+} DirtyRect;
+
+/*
+ * Structure with the necessary context for writing an animation of the maze
+ * generation. The animation is either an APNG file, or a stream of raw RGBA
+ * frames.
+ */
+typedef struct {
+    FILE* fd;
+    bool raw;    /* Raw RGBA frames instead of APNG */
+    bool failed; /* Set if writing a frame failed */
+
+    /* Image of all the layers, stacked vertically */
+    Image canvas;
+
+    /* Pointers used by the views of the canvas */
+    png_bytep* view_rows;
+
+    /* A frame is written every 'step' carves */
+    int step;
+    long num_carves;
+
+    /* Number of written frames, and the offset of the 'acTL' chunk */
+    uint32_t num_frames;
+    long actl_offset;
+
+    /* Sequence number of the next 'fcTL' or 'fdAT' chunk */
+    uint32_t sequence;
+
+    /* Changed rectangle of each layer. Each layer is written as a separate
+     * frame, so a carve between layers doesn't include the layers between
+     * them. */
+    DirtyRect* dirty;
+    int num_layers;
+
+    /* Compressed frame data. Has room for the 'fdAT' sequence number. */
+    uint8_t* zbuf;
+
+    /* Arena of the buffers above, and its position before allocating them */
+    Arena* arena;
+    size_t arena_pos;
+} Animation;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Return the bytes needed in an arena by 'anim_init' for a maze with the
+ * specified size.
+ */
+size_t anim_arena_size(int grid_w, int grid_h, int grid_d);
+
+/*
+ * Initialize an animation of the generation of the specified maze, writing a
+ * frame every STEP carves. If FILENAME is "-", raw RGBA frames are written to
+ * 'stdout'; otherwise, an APNG file is created. The canvas and buffers are
+ * allocated from the arena.
+ *
+ * The maze context is modified so the animation is updated when generating it,
+ * so this function should be called before 'maze_ctx_generate'.
+ */
+bool anim_init(Animation* anim,
+               MazeCtx* maze,
+               Arena* arena,
+               const char* filename,
+               int step);
+
+/*
+ * Write the last frame of the animation, after the maze has been generated,
+ * and release the arena memory used by the animation. Returns false if any
+ * frame couldn't be written.
+ */
+bool anim_finish(Animation* anim, MazeCtx* maze);
+
+#endif /* ANIM_H_ */
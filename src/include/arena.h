@@ -0,0 +1,71 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARENA_H_
+#define ARENA_H_ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Alignment of all the allocations in the arena.
+ */
+#define ARENA_ALIGN 16
+
+/*
+ * Structure representing a region of memory from which all the allocations of
+ * a job are made. Allocations can't be freed individually, but the whole arena
+ * can be freed at once, or the 'pos' member can be saved and restored for
+ * reusing the memory of temporary allocations.
+ */
+typedef struct {
+    uint8_t* data;
+    size_t size; /* Total bytes */
+    size_t pos;  /* Bytes in use */
+} Arena;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Return the bytes used in the arena by an allocation of the specified size,
+ * including the alignment padding.
+ */
+static inline size_t arena_aligned(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+/*
+ * Initialize an arena with the specified size, in bytes. If enabled in the
+ * configuration, the arena is backed by huge pages when possible.
+ */
+bool arena_init(Arena* arena, size_t size);
+
+/*
+ * Free the memory of the arena, and therefore all of its allocations. Doesn't
+ * free the argument pointer itself.
+ */
+void arena_destroy(Arena* arena);
+
+/*
+ * Allocate SIZE bytes from the arena. Returns NULL if there is not enough
+ * space left.
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+#endif /* ARENA_H_ */
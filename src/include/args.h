@@ -0,0 +1,52 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ARGS_H_
+#define ARGS_H_ 1
+
+#include <stdbool.h>
+
+/*
+ * Structure representing the parsed program arguments.
+ */
+typedef struct {
+    const char* output_filename;
+    bool per_layer; /* OUTPUT_FILENAME is the format of one PNG per layer */
+    const char* stats_filename; /* Optional, NULL if not specified */
+    const char* anim_filename;  /* Optional, NULL if not specified */
+    const char* mask_filename;  /* Optional, NULL if not specified */
+    int anim_step;
+    bool render;
+    int grid_w, grid_h, grid_d;
+    unsigned int seed;
+} Args;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Parse the program arguments into the 'Args' structure. Returns false if the
+ * arguments are invalid.
+ */
+bool parse_args(Args* args, int argc, char** argv);
+
+/*
+ * Print the program usage to 'stderr'. NAME is the name of the program.
+ */
+void print_usage(const char* name);
+
+#endif /* ARGS_H_ */
@@ -25,12 +25,20 @@
 
 #define COL_BACKGROUND 0x000000FF
 #define COL_WALL       0xFFFFFFFF
+#define COL_UP         0x3080FFFF /* Passage to the previous layer */
+#define COL_DOWN       0xFF8030FF /* Passage to the next layer */
 
 #define CELL_SZ    10 /* px */
 #define WALL_WIDTH 2  /* px */
 
 #define BIAS_HORIZ 1 /* 1-N */
 #define BIAS_VERT  1 /* 1-N */
+#define BIAS_LAYER 1 /* 1-N */
+
+#define ARENA_HUGE_PAGES 1 /* 0 or 1 */
+
+#define ANIM_STEP     10 /* Carves per frame, by default */
+#define ANIM_DELAY_MS 20 /* Delay between frames */
 
 /*
  * Grid positions of entrance and exit of the mace.
@@ -39,7 +47,9 @@
  */
 #define START_X 0
 #define START_Y 0
+#define START_Z 0
 #define END_X   (ctx->grid_w - 1)
 #define END_Y   (ctx->grid_h - 1)
+#define END_Z   (ctx->grid_d - 1)
 
 #endif /* CONFIG_H_ */
@@ -19,12 +19,20 @@
 #ifndef IMAGE_H_
 #define IMAGE_H_ 1
 
+#include <stddef.h>
 #include <stdbool.h>
 
 #include <png.h>
 
 #include "maze_ctx.h"
+#include "arena.h"
 
+/* Bytes of each pixel in an 'Image' */
+#define COL_SZ 4
+
+/*
+ * Structure representing an RGBA image.
+ */
 typedef struct {
     png_bytep* rows;
     int img_w, img_h; /* Pixels */
@@ -32,6 +40,66 @@ typedef struct {
 
 /*----------------------------------------------------------------------------*/
 
-bool write_png_from_maze_ctx(const MazeCtx* maze, const char* output_filename);
+/*
+ * Check if FMT can be used as the format of the layer filenames: it must have
+ * exactly one "%d" conversion, optionally with flags, width and precision, and
+ * no other conversions apart from the escaped "%%". Other filenames are used
+ * literally.
+ */
+bool image_is_layer_format(const char* fmt);
+
+/*
+ * Return the bytes needed in an arena by 'image_init' for an image with the
+ * specified size, in pixels.
+ */
+size_t image_arena_size(int img_w, int img_h);
+
+/*
+ * Allocate the rows of an image with the specified size, in pixels, from the
+ * specified arena. The pixels of all rows are contiguous.
+ */
+bool image_init(Image* img, Arena* arena, int img_w, int img_h);
+
+/*
+ * Initialize VIEW as a rectangle of IMG, starting at (X, Y), with the specified
+ * size. The view uses the ROWS array, which must be able to hold H pointers,
+ * and shares the pixels of IMG, so it doesn't need to be destroyed.
+ */
+void image_view(Image* view,
+                png_bytep* rows,
+                const Image* img,
+                int x,
+                int y,
+                int w,
+                int h);
+
+/*
+ * Draw the part of the maze that overlaps the specified image, where the image
+ * represents a rectangle of the vertically stacked layers starting at pixel
+ * (PX_X, PX_Y).
+ */
+void maze_region_to_image(Image* img,
+                          const MazeCtx* maze,
+                          int px_x,
+                          int px_y);
+
+/*
+ * Write all the layers of the maze into a single PNG file, stacked vertically.
+ * A single layer is stored in memory, which is allocated from the arena and
+ * released before returning.
+ */
+bool write_png_from_maze_ctx(const MazeCtx* maze,
+                             Arena* arena,
+                             const char* output_filename);
+
+/*
+ * Write each layer of the maze into a separate PNG file. The filename of each
+ * layer is obtained by replacing the "%d" in FILENAME_FMT with the layer
+ * number. A single layer is stored in memory, which is allocated from the
+ * arena and released before returning.
+ */
+bool write_layer_pngs_from_maze_ctx(const MazeCtx* maze,
+                                    Arena* arena,
+                                    const char* filename_fmt);
 
 #endif /* IMAGE_H_ */
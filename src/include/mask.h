@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef MASK_H_
+#define MASK_H_ 1
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <png.h>
+
+#include "arena.h"
+
+/*
+ * Structure representing a mask image, which restricts the cells of the maze.
+ * The image is scaled to the size of the grid, and a cell only exists if the
+ * pixel at its center is light and opaque.
+ */
+typedef struct {
+    png_image png; /* Only used while loading */
+    uint8_t* pixels; /* Gray and alpha bytes of each pixel */
+    int w, h;
+} Mask;
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Open the specified PNG file as a mask, reading its size.
+ */
+bool mask_open(Mask* mask, const char* filename);
+
+/*
+ * Open a PNG file stored in memory as a mask, reading its size. The data must
+ * be valid until the mask is loaded or closed.
+ */
+bool mask_open_memory(Mask* mask, const void* data, size_t size);
+
+/*
+ * Return the bytes needed in an arena by 'mask_load', once the mask has been
+ * opened.
+ */
+size_t mask_arena_size(const Mask* mask);
+
+/*
+ * Read the pixels of a mask opened with 'mask_open', allocating them from the
+ * specified arena.
+ */
+bool mask_load(Mask* mask, Arena* arena);
+
+/*
+ * Release the resources used for reading the mask, if it was opened with
+ * 'mask_open' but not loaded with 'mask_load'. The pixels are part of the
+ * arena, so they are not freed.
+ */
+void mask_close(Mask* mask);
+
+/*
+ * Check if the cell at the specified position, in a grid of GRID_W by GRID_H
+ * cells, is part of the mask.
+ */
+bool mask_contains(const Mask* mask, int x, int y, int grid_w, int grid_h);
+
+#endif /* MASK_H_ */
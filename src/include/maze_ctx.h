@@ -19,12 +19,15 @@
 #ifndef MAZE_CTX_H_
 #define MAZE_CTX_H_ 1
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
 #include <png.h>
 
 #include "vec.h"
+#include "arena.h"
+#include "mask.h"
 
 /*----------------------------------------------------------------------------*/
 
@@ -37,6 +40,8 @@ enum EWalls {
     WALL_SOUTH   = (1 << 1),
     WALL_WEST    = (1 << 2),
     WALL_EAST    = (1 << 3),
+    WALL_UP      = (1 << 4), /* Towards the previous layer */
+    WALL_DOWN    = (1 << 5), /* Towards the next layer */
 };
 
 /*----------------------------------------------------------------------------*/
@@ -47,34 +52,97 @@ enum EWalls {
 typedef struct {
     uint8_t walls; /* Each bit represents a wall from the enumeration */
     bool visited;
+    bool active; /* False if the cell was excluded by a mask */
 } MazeCell;
 
 /*
- * Structure with the necessary context for generating mazes.
+ * Structure representing a horizontal span of active cells in a row.
  */
 typedef struct {
+    int x0, x1; /* From X0 to X1, not included */
+} MazeSpan;
+
+/*
+ * Structure with the necessary context for generating mazes.
+ */
+typedef struct MazeCtx {
+    /* Layers are stored one after the other, each one contiguous */
     MazeCell* grid;
     int grid_w, grid_h; /* Cell number, not pixels */
+    int grid_d;         /* Layer number */
+
+    /*
+     * Spans of active cells in each row, shared by all layers. The spans of
+     * row Y start at index 'row_spans[Y]' and end at 'row_spans[Y + 1]'.
+     */
+    MazeSpan* spans;
+    size_t* row_spans;
+
+    /* Positions of the entrance and exit, which must be active cells */
+    Vec3 start, end;
 
     /* Stack of recently visited positions */
-    Vec2Stack visited_stack;
+    Vec3Stack visited_stack;
+
+    /*
+     * Optional function called after removing the walls between cells A and B
+     * while generating the maze. The 'carve_data' member is passed as the last
+     * argument.
+     */
+    void (*on_carve)(const struct MazeCtx* ctx, Vec3 a, Vec3 b, void* data);
+    void* carve_data;
 } MazeCtx;
 
 /*----------------------------------------------------------------------------*/
 
 /*
- * Initialize a 'MazeCtx' structure with the specified grid width and height.
+ * Return the index of the cell at the specified position inside the
+ * 'MazeCtx.grid' array.
+ */
+static inline size_t maze_ctx_idx(const MazeCtx* ctx, int x, int y, int z) {
+    return ((size_t)ctx->grid_h * z + y) * ctx->grid_w + x;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Return the bytes needed in an arena by 'maze_ctx_init' for a maze with the
+ * specified size.
+ */
+size_t maze_ctx_arena_size(int grid_w, int grid_h, int grid_d);
+
+/*
+ * Initialize a 'MazeCtx' structure with the specified grid width, height and
+ * number of layers. Its members are allocated from the specified arena, so
+ * they are freed along with it.
+ */
+bool maze_ctx_init(MazeCtx* ctx,
+                   Arena* arena,
+                   int grid_w,
+                   int grid_h,
+                   int grid_d);
+
+/*
+ * Return the bytes needed in an arena by 'maze_ctx_set_mask' for a maze with
+ * the specified size.
  */
-bool maze_ctx_init(MazeCtx* ctx, int grid_w, int grid_h);
+size_t maze_ctx_mask_arena_size(int grid_w, int grid_h);
 
 /*
- * Destroy a maze context, freeing its necessary members. Doesn't free the
- * argument pointer itself.
+ * Restrict the cells of the maze to the ones contained in the specified mask.
+ * Only the largest connected region of the mask is kept, and the number of
+ * cells of the mask that were excluded from the other regions is stored in
+ * NUM_REMOVED. The entrance and exit are moved if they are not contained in
+ * the kept region.
  */
-void maze_ctx_destroy(MazeCtx* ctx);
+bool maze_ctx_set_mask(MazeCtx* ctx,
+                       Arena* arena,
+                       const Mask* mask,
+                       size_t* num_removed);
 
 /*
- * Generate a maze using the specified context.
+ * Generate a maze using the specified context. The maze depends on the state
+ * of 'rand', so the caller is responsible for seeding it with 'srand'.
  */
 void maze_ctx_generate(MazeCtx* ctx);
 
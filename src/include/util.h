@@ -22,6 +22,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#define MIN(A, B) ((A) < (B) ? (A) : (B))
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+
 #define ERR(...)                                                               \
     do {                                                                       \
         fprintf(stderr, "%s: ", __func__);                                     \
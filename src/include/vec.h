@@ -22,48 +22,45 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "arena.h"
+
 /*
  * Simple constructor macro.
  */
-#define VEC2(X, Y) ((Vec2){ .x = (X), .y = (Y) })
+#define VEC3(X, Y, Z) ((Vec3){ .x = (X), .y = (Y), .z = (Z) })
 
 /*
- * Structure representing a 2D vector.
+ * Structure representing a 3D vector.
  */
 typedef struct {
-    int x, y;
-} Vec2;
+    int x, y, z;
+} Vec3;
 
 /*
- * Structure representing a stack of 2D vectors.
+ * Structure representing a stack of 3D vectors.
  */
 typedef struct {
-    Vec2* data;
+    Vec3* data;
     size_t pos;
     size_t size;
-} Vec2Stack;
+} Vec3Stack;
 
 /*----------------------------------------------------------------------------*/
 
 /*
- * Initialize a 2D vector stack.
- */
-bool vec_stack_init(Vec2Stack* stack, size_t size);
-
-/*
- * Destroy a 2D vector stack, freeing its necessary members. Doesn't free the
- * argument pointer itself.
+ * Initialize a 3D vector stack that can hold SIZE elements, allocated from the
+ * specified arena.
  */
-void vec_stack_destroy(Vec2Stack* stack);
+bool vec_stack_init(Vec3Stack* stack, Arena* arena, size_t size);
 
 /*
- * Push an element into the top of a 2D vector stack.
+ * Push an element into the top of a 3D vector stack.
  */
-void vec_stack_push(Vec2Stack* stack, Vec2 v);
+void vec_stack_push(Vec3Stack* stack, Vec3 v);
 
 /*
- * Pop an element from the top of a 2D vector stack.
+ * Pop an element from the top of a 3D vector stack.
  */
-Vec2 vec_stack_pop(Vec2Stack* stack);
+Vec3 vec_stack_pop(Vec3Stack* stack);
 
 #endif /* VEC_H_ */
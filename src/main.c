@@ -20,65 +20,151 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "include/util.h"
+#include "include/args.h"
 #include "include/vec.h"
+#include "include/arena.h"
 #include "include/maze_ctx.h"
+#include "include/mask.h"
 #include "include/image.h"
+#include "include/analysis.h"
+#include "include/anim.h"
+#include "include/config.h"
 
 /*
- * Structure representing the parsed program arguments.
+ * Return the bytes needed in the arena for the whole job. The maze context and
+ * the optional mask are kept until the end, but the animation, analysis and
+ * image are used one after the other, so they can share the rest of the arena.
  */
-typedef struct {
-    const char* output_filename;
-    int grid_w, grid_h;
-} Args;
-
-/*----------------------------------------------------------------------------*/
-
-static bool parse_args(Args* args, int argc, char** argv) {
-    /* Default arguments */
-    args->output_filename = "output.png";
-    args->grid_w          = 100;
-    args->grid_h          = 100;
-
-    if (argc >= 2)
-        args->output_filename = argv[1];
-
-    if (argc >= 3)
-        args->grid_w = atoi(argv[2]);
-    if (argc >= 4)
-        args->grid_h = atoi(argv[3]);
-
-    if (args->grid_w <= 0 || args->grid_h <= 0) {
-        ERR("Invalid grid size.");
-        return false;
-    }
+static size_t job_arena_size(const Args* args, const Mask* mask) {
+    const int w = args->grid_w;
+    const int h = args->grid_h;
+    const int d = args->grid_d;
+
+    size_t temporary = 0;
+    if (args->anim_filename != NULL)
+        temporary = MAX(temporary, anim_arena_size(w, h, d));
+    if (args->stats_filename != NULL)
+        temporary = MAX(temporary, maze_stats_arena_size(w, h, d));
+    if (args->render)
+        temporary =
+          MAX(temporary, image_arena_size(w * CELL_SZ, h * CELL_SZ));
+
+    size_t result = maze_ctx_arena_size(w, h, d) + temporary;
+    if (mask != NULL)
+        result += mask_arena_size(mask) + maze_ctx_mask_arena_size(w, h);
 
-    return true;
+    return result;
 }
 
 int main(int argc, char** argv) {
     Args args;
     if (!parse_args(&args, argc, argv)) {
-        fprintf(stderr, "Usage: %s [OUTPUT.png] [WIDTH] [HEIGHT]\n", argv[0]);
+        print_usage(argv[0]);
         return 1;
     }
 
+    /* The size of the mask is needed before allocating the arena */
+    Mask mask;
+    if (args.mask_filename != NULL && !mask_open(&mask, args.mask_filename))
+        return 1;
+
+    const size_t arena_size =
+      job_arena_size(&args, (args.mask_filename != NULL) ? &mask : NULL);
+    fprintf(stderr, "Allocating %zu bytes...\n", arena_size);
+
+    Arena arena;
+    if (!arena_init(&arena, arena_size)) {
+        ERR("Failed to allocate arena.");
+        if (args.mask_filename != NULL)
+            mask_close(&mask);
+        return 1;
+    }
+
+    /* After allocating the arena, errors jump to the end for releasing it */
+    int result = 1;
+
     MazeCtx ctx;
-    if (!maze_ctx_init(&ctx, args.grid_w, args.grid_h)) {
+    if (!maze_ctx_init(&ctx,
+                       &arena,
+                       args.grid_w,
+                       args.grid_h,
+                       args.grid_d)) {
         ERR("Failed to initialize maze context.");
-        return 1;
+        goto done;
     }
 
+    if (args.mask_filename != NULL) {
+        size_t num_removed;
+        if (!mask_load(&mask, &arena) ||
+            !maze_ctx_set_mask(&ctx, &arena, &mask, &num_removed)) {
+            ERR("Failed to apply mask.");
+            goto done;
+        }
+
+        if (num_removed > 0)
+            fprintf(stderr,
+                    "Removed %zu cells not connected to the largest region of "
+                    "the mask.\n",
+                    num_removed);
+    }
+
+    Animation anim;
+    if (args.anim_filename != NULL &&
+        !anim_init(&anim,
+                   &ctx,
+                   &arena,
+                   args.anim_filename,
+                   args.anim_step)) {
+        ERR("Failed to initialize animation.");
+        goto done;
+    }
+
+    fprintf(stderr,
+            "Generating %dx%dx%d maze with seed %u...\n",
+            args.grid_w,
+            args.grid_h,
+            args.grid_d,
+            args.seed);
+    srand(args.seed);
     maze_ctx_generate(&ctx);
 
-    if (!write_png_from_maze_ctx(&ctx, args.output_filename)) {
-        ERR("Failed to generate PNG image from maze.");
-        return 1;
+    if (args.anim_filename != NULL && !anim_finish(&anim, &ctx)) {
+        ERR("Failed to write animation.");
+        goto done;
     }
 
-    puts("Done.");
-    maze_ctx_destroy(&ctx);
-    return 0;
+    if (args.stats_filename != NULL) {
+        MazeStats stats;
+        if (!maze_stats_compute(&stats, &ctx, &arena) ||
+            !maze_stats_write_json(&stats, args.stats_filename)) {
+            ERR("Failed to analyze maze.");
+            goto done;
+        }
+    }
+
+    if (args.render) {
+        /* If the filename is a format, write one PNG per layer */
+        const bool success =
+          args.per_layer
+            ? write_layer_pngs_from_maze_ctx(&ctx,
+                                             &arena,
+                                             args.output_filename)
+            : write_png_from_maze_ctx(&ctx, &arena, args.output_filename);
+        if (!success) {
+            ERR("Failed to generate PNG image from maze.");
+            goto done;
+        }
+    }
+
+    fputs("Done.\n", stderr);
+    result = 0;
+
+done:
+    if (args.mask_filename != NULL)
+        mask_close(&mask);
+    arena_destroy(&arena);
+    return result;
 }
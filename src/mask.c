@@ -0,0 +1,121 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <string.h>
+
+#include <png.h>
+
+#include "include/mask.h"
+#include "include/arena.h"
+#include "include/util.h"
+
+/* Bytes of each pixel in the mask: gray and alpha */
+#define MASK_COL_SZ 2
+
+/* Minimum value of the gray and alpha channels for a pixel to be included */
+#define MASK_THRESHOLD 0x80
+
+/*
+ * Initialize the 'png_image' structure of the mask before opening it.
+ */
+static void init_png(Mask* mask) {
+    memset(&mask->png, 0, sizeof(mask->png));
+    mask->png.version = PNG_IMAGE_VERSION;
+    mask->pixels      = NULL;
+}
+
+/*
+ * Store the size of the mask, once the PNG header has been read.
+ */
+static bool opened_png(Mask* mask) {
+    if (mask->png.width > INT_MAX || mask->png.height > INT_MAX) {
+        ERR("Mask is too big.");
+        png_image_free(&mask->png);
+        return false;
+    }
+
+    mask->png.format = PNG_FORMAT_GA;
+    mask->w          = mask->png.width;
+    mask->h          = mask->png.height;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool mask_open(Mask* mask, const char* filename) {
+    init_png(mask);
+
+    if (!png_image_begin_read_from_file(&mask->png, filename)) {
+        ERR("Can't read mask '%s': %s", filename, mask->png.message);
+        return false;
+    }
+
+    return opened_png(mask);
+}
+
+bool mask_open_memory(Mask* mask, const void* data, size_t size) {
+    init_png(mask);
+
+    if (!png_image_begin_read_from_memory(&mask->png, data, size)) {
+        ERR("Can't read mask: %s", mask->png.message);
+        return false;
+    }
+
+    return opened_png(mask);
+}
+
+size_t mask_arena_size(const Mask* mask) {
+    return arena_aligned((size_t)mask->w * mask->h * MASK_COL_SZ);
+}
+
+bool mask_load(Mask* mask, Arena* arena) {
+    mask->pixels =
+      arena_alloc(arena, (size_t)mask->w * mask->h * MASK_COL_SZ);
+    if (mask->pixels == NULL) {
+        ERR("Failed to allocate mask.");
+        png_image_free(&mask->png);
+        return false;
+    }
+
+    if (!png_image_finish_read(&mask->png, NULL, mask->pixels, 0, NULL)) {
+        ERR("Can't read mask: %s", mask->png.message);
+        png_image_free(&mask->png);
+        return false;
+    }
+
+    return true;
+}
+
+void mask_close(Mask* mask) {
+    /* Does nothing if the image was already freed by 'png_image_finish_read' */
+    png_image_free(&mask->png);
+}
+
+bool mask_contains(const Mask* mask, int x, int y, int grid_w, int grid_h) {
+    /* Position of the pixel at the center of the cell */
+    const size_t px_x = ((size_t)x * 2 + 1) * mask->w / (2 * (size_t)grid_w);
+    const size_t px_y = ((size_t)y * 2 + 1) * mask->h / (2 * (size_t)grid_h);
+
+    const uint8_t* pixel =
+      &mask->pixels[(px_y * mask->w + px_x) * MASK_COL_SZ];
+    return pixel[0] >= MASK_THRESHOLD && pixel[1] >= MASK_THRESHOLD;
+}
@@ -18,37 +18,47 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
-#include <time.h>
 
 #include "include/maze_ctx.h"
 #include "include/util.h"
 #include "include/vec.h"
+#include "include/arena.h"
+#include "include/mask.h"
 #include "include/config.h"
 
 /*
  * Return a random adjacent cell which has not been visited.
  */
-static enum EWalls random_unvisited_neighbour(MazeCtx* ctx, Vec2 v) {
+static enum EWalls random_unvisited_neighbour(MazeCtx* ctx, Vec3 v) {
     const int x = v.x;
     const int y = v.y;
+    const int z = v.z;
 
-    enum EWalls possible_walls[4 * BIAS_VERT * BIAS_HORIZ];
+    enum EWalls
+      possible_walls[2 * BIAS_VERT + 2 * BIAS_HORIZ + 2 * BIAS_LAYER];
     int num_stored = 0;
 
-    if (y >= 1 && ctx->grid[ctx->grid_w * (y - 1) + x].visited == false)
+    if (y >= 1 && ctx->grid[maze_ctx_idx(ctx, x, y - 1, z)].visited == false)
         for (int i = 0; i < BIAS_VERT; i++)
             possible_walls[num_stored++] = WALL_NORTH;
     if (y < ctx->grid_h - 1 &&
-        ctx->grid[ctx->grid_w * (y + 1) + x].visited == false)
+        ctx->grid[maze_ctx_idx(ctx, x, y + 1, z)].visited == false)
         for (int i = 0; i < BIAS_VERT; i++)
             possible_walls[num_stored++] = WALL_SOUTH;
-    if (x >= 1 && ctx->grid[ctx->grid_w * y + (x - 1)].visited == false)
+    if (x >= 1 && ctx->grid[maze_ctx_idx(ctx, x - 1, y, z)].visited == false)
         for (int i = 0; i < BIAS_HORIZ; i++)
             possible_walls[num_stored++] = WALL_WEST;
     if (x < ctx->grid_w - 1 &&
-        ctx->grid[ctx->grid_w * y + (x + 1)].visited == false)
+        ctx->grid[maze_ctx_idx(ctx, x + 1, y, z)].visited == false)
         for (int i = 0; i < BIAS_HORIZ; i++)
             possible_walls[num_stored++] = WALL_EAST;
+    if (z >= 1 && ctx->grid[maze_ctx_idx(ctx, x, y, z - 1)].visited == false)
+        for (int i = 0; i < BIAS_LAYER; i++)
+            possible_walls[num_stored++] = WALL_UP;
+    if (z < ctx->grid_d - 1 &&
+        ctx->grid[maze_ctx_idx(ctx, x, y, z + 1)].visited == false)
+        for (int i = 0; i < BIAS_LAYER; i++)
+            possible_walls[num_stored++] = WALL_DOWN;
 
     if (num_stored <= 0)
         return WALL_INVALID;
@@ -60,19 +70,23 @@ static enum EWalls random_unvisited_neighbour(MazeCtx* ctx, Vec2 v) {
 /*
  * Return the position of the cell adjacent to V, given a wall orientation.
  */
-static Vec2 pos_from_wall(Vec2 v, enum EWalls wall) {
+static Vec3 pos_from_wall(Vec3 v, enum EWalls wall) {
     switch (wall) {
         case WALL_NORTH:
-            return VEC2(v.x, v.y - 1);
+            return VEC3(v.x, v.y - 1, v.z);
         case WALL_SOUTH:
-            return VEC2(v.x, v.y + 1);
+            return VEC3(v.x, v.y + 1, v.z);
         case WALL_WEST:
-            return VEC2(v.x - 1, v.y);
+            return VEC3(v.x - 1, v.y, v.z);
         case WALL_EAST:
-            return VEC2(v.x + 1, v.y);
+            return VEC3(v.x + 1, v.y, v.z);
+        case WALL_UP:
+            return VEC3(v.x, v.y, v.z - 1);
+        case WALL_DOWN:
+            return VEC3(v.x, v.y, v.z + 1);
         default:
             ERR("Invalid wall direction: %d", wall);
-            return VEC2(-1, -1);
+            return VEC3(-1, -1, -1);
     }
 }
 
@@ -89,6 +103,10 @@ static inline int opposite_wall(enum EWalls wall) {
             return WALL_EAST;
         case WALL_EAST:
             return WALL_WEST;
+        case WALL_UP:
+            return WALL_DOWN;
+        case WALL_DOWN:
+            return WALL_UP;
         default:
             ERR("Invalid wall number (%d)", wall);
             return WALL_INVALID;
@@ -99,61 +117,268 @@ static inline int opposite_wall(enum EWalls wall) {
  * Remove the walls between cells A and B. The wall direction is relative to A.
  */
 static inline void remove_walls(MazeCtx* ctx,
-                                Vec2 a,
-                                Vec2 b,
+                                Vec3 a,
+                                Vec3 b,
                                 enum EWalls wall) {
-    ctx->grid[ctx->grid_w * a.y + a.x].walls &= ~wall;
-    ctx->grid[ctx->grid_w * b.y + b.x].walls &= ~opposite_wall(wall);
+    ctx->grid[maze_ctx_idx(ctx, a.x, a.y, a.z)].walls &= ~wall;
+    ctx->grid[maze_ctx_idx(ctx, b.x, b.y, b.z)].walls &= ~opposite_wall(wall);
+}
+
+/*
+ * Allocate and fill the spans of active cells of each row, from the cells of
+ * the first layer.
+ */
+static bool build_spans(MazeCtx* ctx, Arena* arena) {
+    size_t num_spans = 0;
+    for (int y = 0; y < ctx->grid_h; y++)
+        for (int x = 0; x < ctx->grid_w; x++)
+            if (ctx->grid[maze_ctx_idx(ctx, x, y, 0)].active &&
+                (x == 0 || !ctx->grid[maze_ctx_idx(ctx, x - 1, y, 0)].active))
+                num_spans++;
+
+    ctx->spans     = arena_alloc(arena, num_spans * sizeof(MazeSpan));
+    ctx->row_spans = arena_alloc(arena, (ctx->grid_h + 1) * sizeof(size_t));
+    if (ctx->spans == NULL || ctx->row_spans == NULL)
+        return false;
+
+    num_spans = 0;
+    for (int y = 0; y < ctx->grid_h; y++) {
+        ctx->row_spans[y] = num_spans;
+
+        for (int x = 0; x < ctx->grid_w; x++) {
+            if (!ctx->grid[maze_ctx_idx(ctx, x, y, 0)].active)
+                continue;
+
+            /* Extend the current span, or start a new one */
+            if (x > 0 && ctx->grid[maze_ctx_idx(ctx, x - 1, y, 0)].active) {
+                ctx->spans[num_spans - 1].x1 = x + 1;
+            } else {
+                ctx->spans[num_spans].x0 = x;
+                ctx->spans[num_spans].x1 = x + 1;
+                num_spans++;
+            }
+        }
+    }
+    ctx->row_spans[ctx->grid_h] = num_spans;
+
+    return true;
+}
+
+/*
+ * Mark the active cells of the first layer that are connected to START, and
+ * that were not visited yet, as visited. Uses the visited stack for the flood
+ * fill. Returns the number of marked cells.
+ */
+static size_t flood_fill(MazeCtx* ctx, Vec3 start) {
+    ctx->grid[maze_ctx_idx(ctx, start.x, start.y, 0)].visited = true;
+    vec_stack_push(&ctx->visited_stack, start);
+    size_t result = 1;
+
+    for (;;) {
+        const Vec3 cur_pos = vec_stack_pop(&ctx->visited_stack);
+        if (cur_pos.x < 0 || cur_pos.y < 0)
+            break;
+
+        const Vec3 neighbours[] = {
+            VEC3(cur_pos.x, cur_pos.y - 1, 0),
+            VEC3(cur_pos.x, cur_pos.y + 1, 0),
+            VEC3(cur_pos.x - 1, cur_pos.y, 0),
+            VEC3(cur_pos.x + 1, cur_pos.y, 0),
+        };
+
+        for (size_t i = 0; i < sizeof(neighbours) / sizeof(*neighbours); i++) {
+            const Vec3 v = neighbours[i];
+            if (v.x < 0 || v.x >= ctx->grid_w || v.y < 0 || v.y >= ctx->grid_h)
+                continue;
+
+            MazeCell* cell = &ctx->grid[maze_ctx_idx(ctx, v.x, v.y, 0)];
+            if (!cell->active || cell->visited)
+                continue;
+
+            cell->visited = true;
+            vec_stack_push(&ctx->visited_stack, v);
+            result++;
+        }
+    }
+
+    return result;
+}
+
+/*
+ * Clear the visited flag of the cells in the first layer.
+ */
+static void clear_visited(MazeCtx* ctx) {
+    for (int y = 0; y < ctx->grid_h; y++)
+        for (int x = 0; x < ctx->grid_w; x++)
+            ctx->grid[maze_ctx_idx(ctx, x, y, 0)].visited = false;
+}
+
+/*
+ * Exclude the cells of the first layer that are not part of the largest
+ * connected region of active cells. If there are multiple regions with that
+ * size, the first one is kept. Returns the number of excluded cells.
+ */
+static size_t keep_largest_region(MazeCtx* ctx) {
+    clear_visited(ctx);
+
+    size_t total_size = 0, largest_size = 0;
+    Vec3 largest = VEC3(-1, -1, 0);
+    for (int y = 0; y < ctx->grid_h; y++) {
+        for (int x = 0; x < ctx->grid_w; x++) {
+            const MazeCell* cell = &ctx->grid[maze_ctx_idx(ctx, x, y, 0)];
+            if (!cell->active || cell->visited)
+                continue;
+
+            const size_t size = flood_fill(ctx, VEC3(x, y, 0));
+            total_size += size;
+            if (size > largest_size) {
+                largest_size = size;
+                largest      = VEC3(x, y, 0);
+            }
+        }
+    }
+
+    /* Fill the largest region again, and exclude the rest */
+    clear_visited(ctx);
+    if (largest_size > 0)
+        flood_fill(ctx, largest);
+
+    for (int y = 0; y < ctx->grid_h; y++) {
+        for (int x = 0; x < ctx->grid_w; x++) {
+            MazeCell* cell = &ctx->grid[maze_ctx_idx(ctx, x, y, 0)];
+            cell->active   = cell->active && cell->visited;
+        }
+    }
+
+    return total_size - largest_size;
 }
 
 /*----------------------------------------------------------------------------*/
 
-bool maze_ctx_init(MazeCtx* ctx, int grid_w, int grid_h) {
+size_t maze_ctx_arena_size(int grid_w, int grid_h, int grid_d) {
+    const size_t num_cells = (size_t)grid_w * grid_h * grid_d;
+    return arena_aligned(num_cells * sizeof(MazeCell)) +
+           arena_aligned(num_cells * sizeof(Vec3)) +
+           arena_aligned(grid_h * sizeof(MazeSpan)) +
+           arena_aligned((grid_h + 1) * sizeof(size_t));
+}
+
+bool maze_ctx_init(MazeCtx* ctx,
+                   Arena* arena,
+                   int grid_w,
+                   int grid_h,
+                   int grid_d) {
     ctx->grid_w = grid_w;
     ctx->grid_h = grid_h;
+    ctx->grid_d = grid_d;
+
+    ctx->on_carve   = NULL;
+    ctx->carve_data = NULL;
 
-    ctx->grid = calloc(ctx->grid_w * ctx->grid_h, sizeof(MazeCell));
+    const size_t num_cells = (size_t)grid_w * grid_h * grid_d;
+
+    ctx->grid = arena_alloc(arena, num_cells * sizeof(MazeCell));
     if (ctx->grid == NULL) {
         ERR("Failed to allocate grid.");
         return false;
     }
 
-    if (!vec_stack_init(&ctx->visited_stack, ctx->grid_w * ctx->grid_h)) {
-        ERR("Failed to initialize 2D vector stack.");
+    if (!vec_stack_init(&ctx->visited_stack, arena, num_cells)) {
+        ERR("Failed to initialize 3D vector stack.");
+        return false;
+    }
+
+    /* Until a mask is set, all cells are active */
+    for (size_t i = 0; i < num_cells; i++)
+        ctx->grid[i].active = true;
+
+    if (!build_spans(ctx, arena)) {
+        ERR("Failed to allocate spans.");
         return false;
     }
 
+    ctx->start = VEC3(START_X, START_Y, START_Z);
+    ctx->end   = VEC3(END_X, END_Y, END_Z);
+
     return true;
 }
 
-void maze_ctx_destroy(MazeCtx* ctx) {
-    if (ctx->grid != NULL) {
-        free(ctx->grid);
-        ctx->grid = NULL;
+size_t maze_ctx_mask_arena_size(int grid_w, int grid_h) {
+    /* At most, every other cell of a row starts a span */
+    const size_t max_spans = (size_t)grid_h * ((grid_w + 1) / 2);
+    return arena_aligned(max_spans * sizeof(MazeSpan)) +
+           arena_aligned((grid_h + 1) * sizeof(size_t));
+}
+
+bool maze_ctx_set_mask(MazeCtx* ctx,
+                       Arena* arena,
+                       const Mask* mask,
+                       size_t* num_removed) {
+    for (int y = 0; y < ctx->grid_h; y++)
+        for (int x = 0; x < ctx->grid_w; x++)
+            ctx->grid[maze_ctx_idx(ctx, x, y, 0)].active =
+              mask_contains(mask, x, y, ctx->grid_w, ctx->grid_h);
+
+    *num_removed = keep_largest_region(ctx);
+
+    /* If the entrance is not in the region, use the first cell that is */
+    const size_t layer_sz = (size_t)ctx->grid_w * ctx->grid_h;
+    size_t first = maze_ctx_idx(ctx, ctx->start.x, ctx->start.y, 0);
+    for (size_t i = 0; i < layer_sz && !ctx->grid[first].active; i++)
+        first = i;
+    if (!ctx->grid[first].active) {
+        ERR("The mask doesn't contain any cell.");
+        return false;
     }
+    ctx->start.x = first % ctx->grid_w;
+    ctx->start.y = first / ctx->grid_w;
 
-    vec_stack_destroy(&ctx->visited_stack);
-}
+    /* If the exit is not in the region, use the last cell that is */
+    size_t last = maze_ctx_idx(ctx, ctx->end.x, ctx->end.y, 0);
+    for (size_t i = layer_sz; i > 0 && !ctx->grid[last].active; i--)
+        last = i - 1;
+    ctx->end.x = last % ctx->grid_w;
+    ctx->end.y = last / ctx->grid_w;
 
-void maze_ctx_generate(MazeCtx* ctx) {
-    printf("Generating %dx%d maze...\n", ctx->grid_w, ctx->grid_h);
+    /* The mask is the same for all layers */
+    for (int z = 1; z < ctx->grid_d; z++)
+        for (size_t i = 0; i < layer_sz; i++)
+            ctx->grid[layer_sz * z + i].active = ctx->grid[i].active;
 
-    /* Initialize random seed for maze generation */
-    srand(time(NULL));
+    if (!build_spans(ctx, arena)) {
+        ERR("Failed to allocate spans.");
+        return false;
+    }
 
-    /* Clear maze */
-    for (int y = 0; y < ctx->grid_h; y++) {
-        for (int x = 0; x < ctx->grid_w; x++) {
-            ctx->grid[ctx->grid_w * y + x].walls =
-              WALL_NORTH | WALL_SOUTH | WALL_WEST | WALL_EAST;
-            ctx->grid[ctx->grid_w * y + x].visited = false;
-        }
+    return true;
+}
+
+void maze_ctx_generate(MazeCtx* ctx) {
+    /*
+     * Clear maze. Since the layers are contiguous, we can iterate linearly.
+     * Inactive cells have no walls, and are marked as visited so they are
+     * never carved.
+     */
+    const size_t num_cells = (size_t)ctx->grid_w * ctx->grid_h * ctx->grid_d;
+    for (size_t i = 0; i < num_cells; i++) {
+        const bool active = ctx->grid[i].active;
+        ctx->grid[i].walls =
+          active ? (WALL_NORTH | WALL_SOUTH | WALL_WEST | WALL_EAST | WALL_UP |
+                    WALL_DOWN)
+                 : 0;
+        ctx->grid[i].visited = !active;
     }
 
-    /* Push starting position (center) into the stack, and mark as visited */
-    Vec2 cur_pos = VEC2(ctx->grid_w / 2, ctx->grid_h / 2);
+    /*
+     * Push starting position (center, or the entrance if the center is not
+     * active) into the stack, and mark as visited.
+     */
+    Vec3 cur_pos = VEC3(ctx->grid_w / 2, ctx->grid_h / 2, ctx->grid_d / 2);
+    if (!ctx->grid[maze_ctx_idx(ctx, cur_pos.x, cur_pos.y, cur_pos.z)].active)
+        cur_pos = ctx->start;
     vec_stack_push(&ctx->visited_stack, cur_pos);
-    ctx->grid[ctx->grid_w * cur_pos.y + cur_pos.x].visited = true;
+    ctx->grid[maze_ctx_idx(ctx, cur_pos.x, cur_pos.y, cur_pos.z)].visited =
+      true;
 
     /* While we have positions left in the stack */
     for (;;) {
@@ -161,7 +386,7 @@ void maze_ctx_generate(MazeCtx* ctx) {
         cur_pos = vec_stack_pop(&ctx->visited_stack);
 
         /* No more positions to check, we are done */
-        if (cur_pos.x < 0 || cur_pos.y < 0)
+        if (cur_pos.x < 0 || cur_pos.y < 0 || cur_pos.z < 0)
             break;
 
         /* Get a random adjacent cell which has not been visited */
@@ -174,23 +399,29 @@ void maze_ctx_generate(MazeCtx* ctx) {
         vec_stack_push(&ctx->visited_stack, cur_pos);
 
         /* Get position of neighbour from wall orientation */
-        const Vec2 neighbour = pos_from_wall(cur_pos, valid_neighbour_wall);
+        const Vec3 neighbour = pos_from_wall(cur_pos, valid_neighbour_wall);
 
         if (neighbour.x < 0 || neighbour.x >= ctx->grid_w || neighbour.y < 0 ||
-            neighbour.y >= ctx->grid_h) {
+            neighbour.y >= ctx->grid_h || neighbour.z < 0 ||
+            neighbour.z >= ctx->grid_d) {
             ERR("Warning: Neighbour out of bounds.");
             continue;
         }
 
         /* Remove the wall in the current cell and the random neighbour */
         remove_walls(ctx, cur_pos, neighbour, valid_neighbour_wall);
+        if (ctx->on_carve != NULL)
+            ctx->on_carve(ctx, cur_pos, neighbour, ctx->carve_data);
 
         /* Mark neighbour as visited and push to the stack */
-        ctx->grid[ctx->grid_w * neighbour.y + neighbour.x].visited = true;
+        ctx->grid[maze_ctx_idx(ctx, neighbour.x, neighbour.y, neighbour.z)]
+          .visited = true;
         vec_stack_push(&ctx->visited_stack, neighbour);
     }
 
     /* Remove walls of entry and exit */
-    ctx->grid[ctx->grid_w * START_Y + START_X].walls &= ~WALL_NORTH;
-    ctx->grid[ctx->grid_w * END_Y + END_X].walls &= ~WALL_SOUTH;
+    ctx->grid[maze_ctx_idx(ctx, ctx->start.x, ctx->start.y, ctx->start.z)]
+      .walls &= ~WALL_NORTH;
+    ctx->grid[maze_ctx_idx(ctx, ctx->end.x, ctx->end.y, ctx->end.z)].walls &=
+      ~WALL_SOUTH;
 }
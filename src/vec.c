@@ -18,32 +18,25 @@
 
 #include <stddef.h>
 #include <stdbool.h>
-#include <stdlib.h>
 
 #include "include/vec.h"
+#include "include/arena.h"
 
-bool vec_stack_init(Vec2Stack* stack, size_t size) {
+bool vec_stack_init(Vec3Stack* stack, Arena* arena, size_t size) {
     stack->pos = 0;
     stack->size = size;
-    stack->data = calloc(stack->size, sizeof(Vec2));
+    stack->data = arena_alloc(arena, stack->size * sizeof(Vec3));
     return (stack->data != NULL);
 }
 
-void vec_stack_destroy(Vec2Stack* stack) {
-    if (stack->data != NULL) {
-        free(stack->data);
-        stack->data = NULL;
-    }
-}
-
-void vec_stack_push(Vec2Stack* stack, Vec2 v) {
+void vec_stack_push(Vec3Stack* stack, Vec3 v) {
     if (stack->pos < stack->size)
         stack->data[stack->pos++] = v;
 }
 
-Vec2 vec_stack_pop(Vec2Stack* stack) {
+Vec3 vec_stack_pop(Vec3Stack* stack) {
     if (stack->pos <= 0)
-        return VEC2(-1, -1);
+        return VEC3(-1, -1, -1);
 
     return stack->data[--stack->pos];
 }
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "check_maze.h"
+#include "../src/include/maze_ctx.h"
+
+/*
+ * Walls towards each direction, along with the offset of the adjacent cell.
+ */
+static const struct {
+    enum EWalls wall, opposite;
+    int dx, dy, dz;
+} directions[] = {
+    { WALL_NORTH, WALL_SOUTH, 0, -1, 0 }, { WALL_SOUTH, WALL_NORTH, 0, 1, 0 },
+    { WALL_WEST, WALL_EAST, -1, 0, 0 },   { WALL_EAST, WALL_WEST, 1, 0, 0 },
+    { WALL_UP, WALL_DOWN, 0, 0, -1 },     { WALL_DOWN, WALL_UP, 0, 0, 1 },
+};
+
+#define NUM_DIRECTIONS (sizeof(directions) / sizeof(*directions))
+
+/*
+ * Check if the position is inside the grid, and the cell is active.
+ */
+static bool is_inside(const MazeCtx* ctx, int x, int y, int z) {
+    return x >= 0 && x < ctx->grid_w && y >= 0 && y < ctx->grid_h && z >= 0 &&
+           z < ctx->grid_d && ctx->grid[maze_ctx_idx(ctx, x, y, z)].active;
+}
+
+/*
+ * Return the walls of the cell that are expected to be open towards the
+ * outside of the grid, or towards an inactive cell.
+ */
+static uint8_t expected_outer_openings(const MazeCtx* ctx,
+                                       int x,
+                                       int y,
+                                       int z) {
+    uint8_t result = 0;
+
+    if (x == ctx->start.x && y == ctx->start.y && z == ctx->start.z)
+        result |= WALL_NORTH;
+    if (x == ctx->end.x && y == ctx->end.y && z == ctx->end.z)
+        result |= WALL_SOUTH;
+
+    return result;
+}
+
+/*
+ * Check the walls of each active cell, and count the active cells and the
+ * passages between them.
+ */
+static const char* check_walls(const MazeCtx* ctx,
+                               size_t* num_cells,
+                               size_t* num_passages) {
+    *num_cells    = 0;
+    *num_passages = 0;
+
+    for (int z = 0; z < ctx->grid_d; z++) {
+        for (int y = 0; y < ctx->grid_h; y++) {
+            for (int x = 0; x < ctx->grid_w; x++) {
+                const MazeCell* cell = &ctx->grid[maze_ctx_idx(ctx, x, y, z)];
+                if (!cell->active)
+                    continue;
+                if (!cell->visited)
+                    return "Cell was not visited.";
+
+                (*num_cells)++;
+
+                const uint8_t outer = expected_outer_openings(ctx, x, y, z);
+
+                for (size_t i = 0; i < NUM_DIRECTIONS; i++) {
+                    const int nx = x + directions[i].dx;
+                    const int ny = y + directions[i].dy;
+                    const int nz = z + directions[i].dz;
+                    const bool closed = cell->walls & directions[i].wall;
+
+                    if (!is_inside(ctx, nx, ny, nz)) {
+                        if (closed == ((outer & directions[i].wall) != 0))
+                            return "Outer wall in unexpected state.";
+                        continue;
+                    }
+
+                    const MazeCell* neighbour =
+                      &ctx->grid[maze_ctx_idx(ctx, nx, ny, nz)];
+                    const bool neighbour_closed =
+                      neighbour->walls & directions[i].opposite;
+                    if (closed != neighbour_closed)
+                        return "Walls of adjacent cells are not symmetric.";
+
+                    if (!closed)
+                        (*num_passages)++;
+                }
+            }
+        }
+    }
+
+    /* Each passage was counted from both cells */
+    *num_passages /= 2;
+    return NULL;
+}
+
+/*
+ * Count the cells reachable from the entrance, using a depth-first search.
+ */
+static size_t count_reachable(const MazeCtx* ctx) {
+    const size_t num_cells = (size_t)ctx->grid_w * ctx->grid_h * ctx->grid_d;
+
+    bool* reached = calloc(num_cells, sizeof(bool));
+    int* stack    = malloc(num_cells * 3 * sizeof(int));
+    if (reached == NULL || stack == NULL)
+        abort();
+
+    size_t stack_pos = 0;
+    size_t result    = 0;
+
+    reached[maze_ctx_idx(ctx, ctx->start.x, ctx->start.y, ctx->start.z)] = true;
+    stack[stack_pos++] = ctx->start.x;
+    stack[stack_pos++] = ctx->start.y;
+    stack[stack_pos++] = ctx->start.z;
+
+    while (stack_pos > 0) {
+        const int z = stack[--stack_pos];
+        const int y = stack[--stack_pos];
+        const int x = stack[--stack_pos];
+        result++;
+
+        const uint8_t walls = ctx->grid[maze_ctx_idx(ctx, x, y, z)].walls;
+        for (size_t i = 0; i < NUM_DIRECTIONS; i++) {
+            const int nx = x + directions[i].dx;
+            const int ny = y + directions[i].dy;
+            const int nz = z + directions[i].dz;
+            if ((walls & directions[i].wall) || !is_inside(ctx, nx, ny, nz) ||
+                reached[maze_ctx_idx(ctx, nx, ny, nz)])
+                continue;
+
+            reached[maze_ctx_idx(ctx, nx, ny, nz)] = true;
+            stack[stack_pos++] = nx;
+            stack[stack_pos++] = ny;
+            stack[stack_pos++] = nz;
+        }
+    }
+
+    free(reached);
+    free(stack);
+    return result;
+}
+
+/*
+ * Check that the spans of each row contain exactly the active cells.
+ */
+static const char* check_spans(const MazeCtx* ctx) {
+    for (int y = 0; y < ctx->grid_h; y++) {
+        const size_t first = ctx->row_spans[y];
+        const size_t end   = ctx->row_spans[y + 1];
+
+        /* Spans must be sorted, and separated by at least one cell */
+        for (size_t i = first; i < end; i++)
+            if (ctx->spans[i].x0 >= ctx->spans[i].x1 ||
+                ctx->spans[i].x0 < 0 || ctx->spans[i].x1 > ctx->grid_w ||
+                (i > first && ctx->spans[i].x0 <= ctx->spans[i - 1].x1))
+                return "Spans are not sorted.";
+
+        size_t i = first;
+        for (int x = 0; x < ctx->grid_w; x++) {
+            while (i < end && x >= ctx->spans[i].x1)
+                i++;
+            const bool in_span = i < end && x >= ctx->spans[i].x0;
+
+            for (int z = 0; z < ctx->grid_d; z++)
+                if (ctx->grid[maze_ctx_idx(ctx, x, y, z)].active != in_span)
+                    return "Spans don't match the active cells.";
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+const char* check_maze(const MazeCtx* ctx) {
+    if (!is_inside(ctx, ctx->start.x, ctx->start.y, ctx->start.z) ||
+        !is_inside(ctx, ctx->end.x, ctx->end.y, ctx->end.z))
+        return "The entrance or exit is not an active cell.";
+
+    const char* error = check_spans(ctx);
+    if (error != NULL)
+        return error;
+
+    size_t num_cells, num_passages;
+    error = check_walls(ctx, &num_cells, &num_passages);
+    if (error != NULL)
+        return error;
+
+    if (count_reachable(ctx) != num_cells)
+        return "Not all active cells are reachable from the entrance.";
+
+    /* A connected graph with N nodes and N-1 edges is a tree */
+    if (num_passages != num_cells - 1)
+        return "The maze contains cycles.";
+
+    return NULL;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECK_MAZE_H_
+#define CHECK_MAZE_H_ 1
+
+#include "../src/include/maze_ctx.h"
+
+/*
+ * Check the invariants of a perfect maze generated with the specified context:
+ *
+ *   - The spans of each row contain exactly the active cells.
+ *   - The walls between adjacent active cells are symmetric.
+ *   - The walls towards the outside or towards inactive cells are closed,
+ *     except for the entrance and exit.
+ *   - Every active cell was visited, and is reachable from the entrance.
+ *   - There are no cycles, i.e. the passages form a tree.
+ *
+ * Returns NULL if the maze is valid, or a description of the first invariant
+ * that doesn't hold.
+ */
+const char* check_maze(const MazeCtx* ctx);
+
+#endif /* CHECK_MAZE_H_ */
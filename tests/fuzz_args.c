@@ -0,0 +1,69 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Fuzzing harness for the argument parser. The input is split into arguments
+ * at each null byte.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/include/args.h"
+#include "../src/include/image.h"
+#include "../src/include/config.h"
+
+#define MAX_ARGS 16
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    /* Copy the input, so the last argument is always null-terminated */
+    char* input = malloc(size + 1);
+    if (input == NULL)
+        return 0;
+    memcpy(input, data, size);
+    input[size] = '\0';
+
+    char* argv[MAX_ARGS + 1];
+    int argc = 0;
+
+    argv[argc++] = "maze-generator";
+    for (size_t i = 0; i < size && argc < MAX_ARGS; i++)
+        if (i == 0 || input[i - 1] == '\0')
+            argv[argc++] = &input[i];
+    argv[argc] = NULL;
+
+    Args args;
+    if (parse_args(&args, argc, argv)) {
+        /* The rest of the program relies on these */
+        if (args.grid_w <= 0 || args.grid_h <= 0 || args.grid_d <= 0 ||
+            args.anim_step <= 0 || args.output_filename == NULL)
+            abort();
+
+        /* Rows of the images, in bytes, and their height, in pixels */
+        if ((long long)args.grid_w * CELL_SZ * COL_SZ > INT_MAX ||
+            (long long)args.grid_h * args.grid_d * CELL_SZ > INT_MAX)
+            abort();
+    }
+
+    free(input);
+    return 0;
+}
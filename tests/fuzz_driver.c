@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Standalone driver for the fuzzing harnesses, for fuzzers like AFL that run
+ * the program with each input, or for reproducing crashes without libFuzzer.
+ * Each argument is an input file; if there are none, the input is read from
+ * 'stdin'.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+static bool run_file(FILE* fd) {
+    size_t size     = 0;
+    size_t capacity = 0x1000;
+    uint8_t* data   = malloc(capacity);
+    if (data == NULL)
+        return false;
+
+    size_t num_read;
+    while ((num_read = fread(&data[size], 1, capacity - size, fd)) > 0) {
+        size += num_read;
+        if (size < capacity)
+            continue;
+
+        capacity *= 2;
+        uint8_t* new_data = realloc(data, capacity);
+        if (new_data == NULL) {
+            free(data);
+            return false;
+        }
+        data = new_data;
+    }
+
+    LLVMFuzzerTestOneInput(data, size);
+    free(data);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2)
+        return run_file(stdin) ? 0 : 1;
+
+    for (int i = 1; i < argc; i++) {
+        FILE* fd = fopen(argv[i], "rb");
+        if (fd == NULL) {
+            perror(argv[i]);
+            return 1;
+        }
+
+        const bool success = run_file(fd);
+        fclose(fd);
+        if (!success)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Fuzzing harness for the mask loader. The input is read as a PNG file, and
+ * the mask is applied to a maze of a fixed size.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "check_maze.h"
+#include "../src/include/arena.h"
+#include "../src/include/maze_ctx.h"
+#include "../src/include/mask.h"
+
+/* Size of the maze */
+#define GRID_W 32
+#define GRID_H 32
+#define GRID_D 2
+
+/* Bigger masks are skipped, since decoding them is too slow for fuzzing */
+#define MAX_MASK_PIXELS (1024 * 1024)
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    Mask mask;
+    if (!mask_open_memory(&mask, data, size))
+        return 0;
+
+    if ((size_t)mask.w * mask.h > MAX_MASK_PIXELS) {
+        mask_close(&mask);
+        return 0;
+    }
+
+    Arena arena;
+    MazeCtx ctx;
+    if (!arena_init(&arena,
+                    maze_ctx_arena_size(GRID_W, GRID_H, GRID_D) +
+                      mask_arena_size(&mask) +
+                      maze_ctx_mask_arena_size(GRID_W, GRID_H)) ||
+        !maze_ctx_init(&ctx, &arena, GRID_W, GRID_H, GRID_D))
+        abort();
+
+    size_t num_removed;
+    if (!mask_load(&mask, &arena) ||
+        !maze_ctx_set_mask(&ctx, &arena, &mask, &num_removed)) {
+        arena_destroy(&arena);
+        return 0;
+    }
+
+    srand(0);
+    maze_ctx_generate(&ctx);
+
+    const char* error = check_maze(&ctx);
+    if (error != NULL) {
+        fprintf(stderr, "Masked maze: %s\n", error);
+        abort();
+    }
+
+    arena_destroy(&arena);
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Fuzzing harness for the maze generator. The first bytes of the input select
+ * the size of the maze and the seed, and the rest are used as a mask with one
+ * bit per pixel.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "check_maze.h"
+#include "../src/include/arena.h"
+#include "../src/include/maze_ctx.h"
+#include "../src/include/mask.h"
+
+/* Maximum size of the maze, in each dimension */
+#define MAX_W 64
+#define MAX_H 64
+#define MAX_D 8
+
+/* Width of the mask, in pixels. The height depends on the input size. */
+#define MASK_W 16
+
+/* Bytes used for the size and the seed */
+#define HEADER_SZ 7
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < HEADER_SZ)
+        return 0;
+
+    const int w = 1 + data[0] % MAX_W;
+    const int h = 1 + data[1] % MAX_H;
+    const int d = 1 + data[2] % MAX_D;
+    const unsigned int seed =
+      data[3] | data[4] << 8 | data[5] << 16 | (unsigned int)data[6] << 24;
+
+    Arena arena;
+    MazeCtx ctx;
+    if (!arena_init(&arena,
+                    maze_ctx_arena_size(w, h, d) +
+                      maze_ctx_mask_arena_size(w, h)) ||
+        !maze_ctx_init(&ctx, &arena, w, h, d))
+        abort();
+
+    /* Each bit of the remaining bytes is a pixel of the mask */
+    const size_t mask_bytes = (size - HEADER_SZ) / (MASK_W / 8) * (MASK_W / 8);
+    if (mask_bytes > 0) {
+        Mask mask;
+        mask.w      = MASK_W;
+        mask.h      = mask_bytes * 8 / MASK_W;
+        mask.pixels = malloc((size_t)mask.w * mask.h * 2);
+        if (mask.pixels == NULL)
+            abort();
+
+        for (size_t i = 0; i < (size_t)mask.w * mask.h; i++) {
+            const bool bit = data[HEADER_SZ + i / 8] & (1 << (i % 8));
+            mask.pixels[i * 2]     = bit ? 0xFF : 0x00; /* Gray */
+            mask.pixels[i * 2 + 1] = 0xFF;              /* Alpha */
+        }
+
+        size_t num_removed;
+        const bool valid_mask =
+          maze_ctx_set_mask(&ctx, &arena, &mask, &num_removed);
+        free(mask.pixels);
+        if (!valid_mask) {
+            arena_destroy(&arena);
+            return 0;
+        }
+    }
+
+    srand(seed);
+    maze_ctx_generate(&ctx);
+
+    const char* error = check_maze(&ctx);
+    if (error != NULL) {
+        fprintf(stderr, "%dx%dx%d, seed %u: %s\n", w, h, d, seed, error);
+        abort();
+    }
+
+    arena_destroy(&arena);
+    return 0;
+}
@@ -0,0 +1,330 @@
+/*
+ * Copyright 2025 8dcc
+ *
+ * This file is part of maze-generator.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "check_maze.h"
+#include "../src/include/arena.h"
+#include "../src/include/maze_ctx.h"
+#include "../src/include/mask.h"
+#include "../src/include/analysis.h"
+
+/* Number of mazes with random sizes and seeds */
+#define NUM_RANDOM_CASES 300
+
+/* Maximum size of the random mazes, in each dimension */
+#define MAX_RANDOM_W 48
+#define MAX_RANDOM_H 48
+#define MAX_RANDOM_D 4
+
+/* Number of mazes with random masks, and maximum size of the masks */
+#define NUM_MASKED_CASES 200
+#define MAX_MASK_W       32
+#define MAX_MASK_H       32
+
+/*
+ * Sizes that are likely to break the generator.
+ */
+static const struct {
+    int w, h, d;
+} degenerate_sizes[] = {
+    { 1, 1, 1 },  { 1, 2, 1 },  { 2, 1, 1 }, { 1, 100, 1 }, { 100, 1, 1 },
+    { 1, 1, 100 }, { 2, 2, 2 }, { 1, 5, 5 }, { 5, 1, 5 },   { 3, 3, 1 },
+};
+
+static int num_failures = 0;
+
+/*
+ * Simple xorshift generator for the sizes and seeds of the random cases. We
+ * can't use 'rand', since it's used by the maze generator itself.
+ */
+static uint32_t next_random(uint32_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/*
+ * Allocate the pixels of a mask with the specified size. The pixels must be
+ * freed by the caller.
+ */
+static void alloc_mask(Mask* mask, int w, int h) {
+    mask->w      = w;
+    mask->h      = h;
+    mask->pixels = malloc((size_t)w * h * 2);
+    if (mask->pixels == NULL) {
+        fprintf(stderr, "Failed to allocate mask.\n");
+        exit(1);
+    }
+}
+
+/*
+ * Set whether the pixel at the specified position is included in the mask.
+ */
+static void set_mask_pixel(Mask* mask, int x, int y, bool included) {
+    uint8_t* pixel = &mask->pixels[((size_t)y * mask->w + x) * 2];
+    pixel[0]       = included ? 0xFF : 0x00; /* Gray */
+    pixel[1]       = 0xFF;                   /* Alpha */
+}
+
+/*
+ * Return the number of cells of a GRID_W by GRID_H grid that are contained in
+ * the mask.
+ */
+static size_t mask_num_cells(const Mask* mask, int grid_w, int grid_h) {
+    size_t result = 0;
+    for (int y = 0; y < grid_h; y++)
+        for (int x = 0; x < grid_w; x++)
+            if (mask_contains(mask, x, y, grid_w, grid_h))
+                result++;
+    return result;
+}
+
+/*
+ * Fill the mask with random pixels, where roughly DENSITY out of 8 pixels are
+ * included.
+ */
+static void random_mask(Mask* mask, int density, uint32_t* state) {
+    for (int y = 0; y < mask->h; y++)
+        for (int x = 0; x < mask->w; x++)
+            set_mask_pixel(mask,
+                           x,
+                           y,
+                           (int)(next_random(state) % 8) < density);
+}
+
+/*
+ * Generate a maze with the specified size and seed, optionally restricted to a
+ * mask, and check that it's a perfect maze. Also checks that the same seed
+ * always generates the same maze, and that the analysis is consistent with the
+ * maze.
+ */
+static void test_maze(int w,
+                      int h,
+                      int d,
+                      unsigned int seed,
+                      const Mask* mask) {
+    Arena arena;
+    if (!arena_init(&arena,
+                    2 * maze_ctx_arena_size(w, h, d) +
+                      2 * maze_ctx_mask_arena_size(w, h) +
+                      maze_stats_arena_size(w, h, d))) {
+        fprintf(stderr, "Failed to allocate arena.\n");
+        exit(1);
+    }
+
+    MazeCtx ctx, other_ctx;
+    if (!maze_ctx_init(&ctx, &arena, w, h, d) ||
+        !maze_ctx_init(&other_ctx, &arena, w, h, d)) {
+        fprintf(stderr, "Failed to initialize maze context.\n");
+        exit(1);
+    }
+
+    const char* error  = NULL;
+    size_t num_removed = 0;
+    if (mask != NULL &&
+        (!maze_ctx_set_mask(&ctx, &arena, mask, &num_removed) ||
+         !maze_ctx_set_mask(&other_ctx, &arena, mask, &num_removed)))
+        error = "Failed to set mask.";
+
+    if (error == NULL) {
+        srand(seed);
+        maze_ctx_generate(&ctx);
+        srand(seed);
+        maze_ctx_generate(&other_ctx);
+
+        error = check_maze(&ctx);
+    }
+
+    /* The active cells must be in the mask, and the rest must be removed */
+    if (error == NULL && mask != NULL) {
+        size_t num_active = 0;
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                if (!ctx.grid[maze_ctx_idx(&ctx, x, y, 0)].active)
+                    continue;
+
+                num_active++;
+                if (!mask_contains(mask, x, y, w, h))
+                    error = "Active cell is not contained in the mask.";
+            }
+        }
+
+        if (error == NULL &&
+            num_active + num_removed != mask_num_cells(mask, w, h))
+            error = "Cells of the mask are neither active nor removed.";
+    }
+
+    const size_t grid_sz = (size_t)w * h * d;
+    size_t num_cells     = 0;
+    for (size_t i = 0; i < grid_sz; i++)
+        if (ctx.grid[i].active)
+            num_cells++;
+
+    MazeStats stats;
+    if (error == NULL &&
+        memcmp(ctx.grid, other_ctx.grid, grid_sz * sizeof(MazeCell)) != 0)
+        error = "The same seed generated different mazes.";
+    else if (error == NULL && !maze_stats_compute(&stats, &ctx, &arena))
+        error = "Failed to analyze maze.";
+
+    if (error == NULL) {
+        /* The histogram must add up to the cells, and the passages to a tree */
+        size_t total_cells = 0, total_passages = 0;
+        for (int i = 0; i <= MAX_PASSAGES; i++) {
+            total_cells += stats.junctions[i];
+            total_passages += i * stats.junctions[i];
+        }
+
+        if (stats.num_cells != num_cells || total_cells != num_cells ||
+            total_passages != 2 * (num_cells - 1))
+            error = "Junction histogram doesn't match the maze.";
+        else if (stats.solution_len == 0 ||
+                 stats.solution_len > stats.longest_path)
+            error = "Solution is longer than the longest path.";
+    }
+
+    if (error != NULL) {
+        fprintf(stderr,
+                "FAIL: %dx%dx%d, seed %u%s: %s\n",
+                w,
+                h,
+                d,
+                seed,
+                (mask != NULL) ? ", masked" : "",
+                error);
+        num_failures++;
+    }
+
+    arena_destroy(&arena);
+}
+
+/*
+ * Check that only the largest region of a mask with two separate regions is
+ * kept, even if the smaller one contains the default entrance.
+ */
+static void test_mask_regions(void) {
+    const int w = 40, h = 20;
+
+    /* A small square at the top left, and a bigger rectangle at the right */
+    Mask mask;
+    alloc_mask(&mask, w, h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const bool small = x < 6 && y < 6;
+            const bool big   = x >= 15 && x < 38 && y >= 2 && y < 18;
+            set_mask_pixel(&mask, x, y, small || big);
+        }
+    }
+
+    Arena arena;
+    MazeCtx ctx;
+    size_t num_removed;
+    if (!arena_init(&arena,
+                    maze_ctx_arena_size(w, h, 1) +
+                      maze_ctx_mask_arena_size(w, h)) ||
+        !maze_ctx_init(&ctx, &arena, w, h, 1) ||
+        !maze_ctx_set_mask(&ctx, &arena, &mask, &num_removed)) {
+        fprintf(stderr, "Failed to initialize masked maze context.\n");
+        exit(1);
+    }
+
+    srand(0);
+    maze_ctx_generate(&ctx);
+
+    const char* error = check_maze(&ctx);
+    if (error == NULL && num_removed != 6 * 6)
+        error = "The cells of the smaller region were not removed.";
+
+    for (int y = 0; y < h && error == NULL; y++) {
+        for (int x = 0; x < w; x++) {
+            const bool big = x >= 15 && x < 38 && y >= 2 && y < 18;
+            if (ctx.grid[maze_ctx_idx(&ctx, x, y, 0)].active != big) {
+                error = "The largest region of the mask was not kept.";
+                break;
+            }
+        }
+    }
+
+    if (error == NULL && (ctx.start.x != 15 || ctx.start.y != 2 ||
+                          ctx.end.x != 37 || ctx.end.y != 17))
+        error = "The entrance or exit are not in the largest region.";
+
+    if (error != NULL) {
+        fprintf(stderr, "FAIL: Mask with two regions: %s\n", error);
+        num_failures++;
+    }
+
+    arena_destroy(&arena);
+    free(mask.pixels);
+}
+
+int main(void) {
+    int num_tests = 0;
+
+    for (size_t i = 0; i < sizeof(degenerate_sizes) / sizeof(*degenerate_sizes);
+         i++) {
+        test_maze(degenerate_sizes[i].w,
+                  degenerate_sizes[i].h,
+                  degenerate_sizes[i].d,
+                  i,
+                  NULL);
+        num_tests++;
+    }
+
+    uint32_t state = 0x8DCC;
+    for (int i = 0; i < NUM_RANDOM_CASES; i++) {
+        const int w = 1 + next_random(&state) % MAX_RANDOM_W;
+        const int h = 1 + next_random(&state) % MAX_RANDOM_H;
+        const int d = 1 + next_random(&state) % MAX_RANDOM_D;
+        test_maze(w, h, d, next_random(&state), NULL);
+        num_tests++;
+    }
+
+    for (int i = 0; i < NUM_MASKED_CASES; i++) {
+        const int w = 1 + next_random(&state) % MAX_RANDOM_W;
+        const int h = 1 + next_random(&state) % MAX_RANDOM_H;
+        const int d = 1 + next_random(&state) % MAX_RANDOM_D;
+
+        /* Regenerate the mask until it contains at least one cell */
+        Mask mask;
+        alloc_mask(&mask,
+                   1 + next_random(&state) % MAX_MASK_W,
+                   1 + next_random(&state) % MAX_MASK_H);
+        const int density = 1 + next_random(&state) % 8;
+        do {
+            random_mask(&mask, density, &state);
+        } while (mask_num_cells(&mask, w, h) == 0);
+
+        test_maze(w, h, d, next_random(&state), &mask);
+        free(mask.pixels);
+        num_tests++;
+    }
+
+    test_mask_regions();
+    num_tests++;
+
+    printf("%d/%d tests passed.\n", num_tests - num_failures, num_tests);
+    return (num_failures == 0) ? 0 : 1;
+}